@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "allocator.h"
+
+SDL_atomic_t num_allocations;
+
+void* counted_malloc(size_t size) {
+    count_allocation();
+    return malloc(size);
+}
+
+void* counted_realloc(void* pointer, size_t size) {
+    count_allocation();
+    return realloc(pointer, size);
+}
+
+void counted_free(void* pointer) {
+    free(pointer);
+}
+
+void count_allocation(void) {
+    SDL_AtomicAdd(&num_allocations, 1);
+}
+
+int allocation_count(void) {
+    return SDL_AtomicGet(&num_allocations);
+}
+
+size_t align_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// the block header is padded so the data after it stays aligned
+#define ARENA_BLOCK_HEADER_SIZE align_up(sizeof(arena_block_t), ARENA_ALIGNMENT)
+
+arena_block_t* arena_new_block(arena_block_t* previous, size_t size) {
+    arena_block_t* block = (arena_block_t*) counted_malloc(ARENA_BLOCK_HEADER_SIZE + size);
+    block->previous = previous;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    size = align_up(size, ARENA_ALIGNMENT);
+
+    arena_block_t* block = arena->current;
+    if (!block || block->used + size > block->size) {
+        // at least double, so a growing frame chains only a few blocks
+        size_t block_size = block ? block->size * 2 : 64 * 1024;
+        block_size = block_size > size ? block_size : size;
+        block = arena_new_block(block, block_size);
+        arena->current = block;
+    }
+
+    void* pointer = (uint8_t*) block + ARENA_BLOCK_HEADER_SIZE + block->used;
+    block->used += size;
+    arena->used += size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return pointer;
+}
+
+void arena_reset(arena_t* arena) {
+    arena_block_t* block = arena->current;
+    if (block && block->previous) {
+        // more than one block: merge them into one that holds the peak
+        arena_free(arena);
+        arena->current = arena_new_block(NULL, arena->peak);
+        arena->peak = arena->current->size;
+    } else if (block) {
+        block->used = 0;
+    }
+    arena->used = 0;
+}
+
+void arena_free(arena_t* arena) {
+    arena_block_t* block = arena->current;
+    while (block) {
+        arena_block_t* previous = block->previous;
+        counted_free(block);
+        block = previous;
+    }
+    arena->current = NULL;
+    arena->used = 0;
+}
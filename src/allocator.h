@@ -0,0 +1,38 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+
+// malloc/realloc/free that count every heap allocation made through them
+// the frame path allocates through these, so a steady-state frame should leave the counter alone
+void* counted_malloc(size_t size);
+void* counted_realloc(void* pointer, size_t size);
+void counted_free(void* pointer);
+// for allocators that can't go through counted_malloc (SDL_SIMDAlloc)
+void count_allocation(void);
+// total allocations and reallocations since startup
+int allocation_count(void);
+
+// 16 byte alignment is enough for the sse/avx loads used on arena memory
+#define ARENA_ALIGNMENT 16
+
+typedef struct arena_block_t {
+    struct arena_block_t* previous;
+    size_t size;    // usable bytes after the block header
+    size_t used;
+} arena_block_t;
+
+// bump allocator for memory that only lives until the next reset
+// when a frame needs more than the current block another one is chained on,
+// the reset then replaces the chain with a single block big enough for that frame
+typedef struct {
+    arena_block_t* current;
+    size_t used;    // bytes handed out since the last reset, over all blocks
+    size_t peak;
+} arena_t;
+
+void* arena_alloc(arena_t* arena, size_t size);
+void arena_reset(arena_t* arena);
+void arena_free(arena_t* arena);
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+#include "background.h"
+#include "display.h"
+#include "tiles.h"
+#include "profiler.h"
+
+// bit 0: drawn this frame, bit 1: drawn last frame
+#define DIRTY_CURRENT 1
+#define DIRTY_PREVIOUS 2
+
+uint32_t* background_buffer = NULL;
+// display_width, the grid only depends on the pixel position, so smaller frames use its top left corner
+int background_pitch = 0;
+
+uint8_t* dirty_tiles = NULL;
+int dirty_tiles_x = 0;
+int dirty_tiles_y = 0;
+
+void background_initialize(void) {
+    free(background_buffer);
+    free(dirty_tiles);
+
+    background_pitch = display_width;
+    background_buffer = (uint32_t*) malloc(sizeof(uint32_t) * display_width * display_height);
+    for (int r=0; r<display_height; r++) {
+        for (int c=0; c<display_width; c++) {
+            background_buffer[r * background_pitch + c] = r % 10 == 0 || c % 10 == 0 ? 0xFF333333 : 0xFF000000;
+        }
+    }
+
+    // enough tiles for the display size, a smaller frame uses fewer of them
+    dirty_tiles = (uint8_t*) malloc(((display_width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE) * ((display_height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE));
+    // the color buffer starts out as garbage, so the first frame restores everything
+    dirty_resize();
+}
+
+void dirty_resize(void) {
+    dirty_tiles_x = (window_width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    dirty_tiles_y = (window_height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    memset(dirty_tiles, DIRTY_CURRENT, dirty_tiles_x * dirty_tiles_y);
+}
+
+void background_free(void) {
+    free(background_buffer);
+    free(dirty_tiles);
+    background_buffer = NULL;
+    dirty_tiles = NULL;
+}
+
+void dirty_begin_frame(void) {
+    for (int t=0; t<dirty_tiles_x * dirty_tiles_y; t++) {
+        dirty_tiles[t] = (dirty_tiles[t] & DIRTY_CURRENT) ? DIRTY_PREVIOUS : 0;
+    }
+}
+
+void dirty_mark_rect(int min_x, int min_y, int max_x, int max_y) {
+    min_x = min_x < 0 ? 0 : min_x;
+    min_y = min_y < 0 ? 0 : min_y;
+    max_x = max_x > window_width ? window_width : max_x;
+    max_y = max_y > window_height ? window_height : max_y;
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    for (int ty=min_y / DIRTY_TILE_SIZE; ty<=(max_y - 1) / DIRTY_TILE_SIZE; ty++) {
+        for (int tx=min_x / DIRTY_TILE_SIZE; tx<=(max_x - 1) / DIRTY_TILE_SIZE; tx++) {
+            dirty_tiles[ty * dirty_tiles_x + tx] |= DIRTY_CURRENT;
+        }
+    }
+}
+
+void dirty_mark_triangles(const triangle_t* triangles, int num_triangles) {
+    for (int i=0; i<num_triangles; i++) {
+        const triangle_t* triangle = &triangles[i];
+        float min_x = fminf(triangle->points[0].x, fminf(triangle->points[1].x, triangle->points[2].x)) - TILE_BIN_MARGIN;
+        float min_y = fminf(triangle->points[0].y, fminf(triangle->points[1].y, triangle->points[2].y)) - TILE_BIN_MARGIN;
+        float max_x = fmaxf(triangle->points[0].x, fmaxf(triangle->points[1].x, triangle->points[2].x)) + TILE_BIN_MARGIN;
+        float max_y = fmaxf(triangle->points[0].y, fmaxf(triangle->points[1].y, triangle->points[2].y)) + TILE_BIN_MARGIN;
+
+        // same rejection as the binning, written so that NaN coordinates fail it
+        if (!(max_x >= 0 && max_y >= 0 && min_x < window_width && min_y < window_height)) {
+            continue;
+        }
+        dirty_mark_rect(
+            min_x <= 0 ? 0 : (int) min_x,
+            min_y <= 0 ? 0 : (int) min_y,
+            max_x >= window_width ? window_width : (int) max_x + 1,
+            max_y >= window_height ? window_height : (int) max_y + 1
+        );
+    }
+}
+
+void dirty_mark_all(void) {
+    dirty_mark_rect(0, 0, window_width, window_height);
+}
+
+// calls span for every horizontal run of tiles in a tile row that has any of the flags,
+// with the run in pixels
+void for_each_dirty_span(uint8_t flags, void (*span)(int x, int y, int w, int h)) {
+    for (int ty=0; ty<dirty_tiles_y; ty++) {
+        int y = ty * DIRTY_TILE_SIZE;
+        int h = y + DIRTY_TILE_SIZE < window_height ? DIRTY_TILE_SIZE : window_height - y;
+
+        int tx = 0;
+        while (tx < dirty_tiles_x) {
+            if (!(dirty_tiles[ty * dirty_tiles_x + tx] & flags)) {
+                tx++;
+                continue;
+            }
+            int first = tx;
+            while (tx < dirty_tiles_x && (dirty_tiles[ty * dirty_tiles_x + tx] & flags)) {
+                tx++;
+            }
+            int x = first * DIRTY_TILE_SIZE;
+            int w = (tx * DIRTY_TILE_SIZE < window_width ? tx * DIRTY_TILE_SIZE : window_width) - x;
+            span(x, y, w, h);
+        }
+    }
+}
+
+void restore_span(int x, int y, int w, int h) {
+    for (int row=y; row<y + h; row++) {
+        memcpy(&color_buffer[row * color_buffer_pitch + x], &background_buffer[row * background_pitch + x], sizeof(uint32_t) * w);
+    }
+    profile_count("bytes copied", (double) sizeof(uint32_t) * w * h);
+}
+
+void clear_depth_span(int x, int y, int w, int h) {
+    // 0.0f is all zero bits, as in clear_z_buffer
+    for (int row=y; row<y + h; row++) {
+        memset(&z_buffer[row * window_width + x], 0, sizeof(float) * w);
+    }
+}
+
+
+void background_restore(void) {
+    for_each_dirty_span(DIRTY_PREVIOUS, restore_span);
+}
+
+void background_restore_all(void) {
+    restore_span(0, 0, window_width, window_height);
+}
+
+void dirty_clear_z_buffer(void) {
+    for_each_dirty_span(DIRTY_CURRENT, clear_depth_span);
+}
+
+void render_dirty_color_buffer(void) {
+    // last frame's pixels that were restored have to reach the texture as well
+    for_each_dirty_span(DIRTY_CURRENT | DIRTY_PREVIOUS, update_color_buffer_texture);
+    show_color_buffer_texture();
+}
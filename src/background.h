@@ -0,0 +1,36 @@
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+#include <stdint.h>
+#include "triangle.h"
+
+// dirty regions are tracked per square tile of this many pixels
+#define DIRTY_TILE_SIZE 64
+
+// what an empty frame looks like, the grid drawn once at startup
+extern uint32_t* background_buffer;
+
+// renders the background for the display size and marks the whole screen dirty
+void background_initialize(void);
+// follows a change of the render size, the whole screen is dirty afterwards
+void dirty_resize(void);
+void background_free(void);
+
+// starts a frame: what was drawn last frame becomes the previous dirty region, the current one is empty
+void dirty_begin_frame(void);
+// marks the pixels [min_x, max_x) x [min_y, max_y) as drawn this frame, clamped to the window
+void dirty_mark_rect(int min_x, int min_y, int max_x, int max_y);
+// the bounding boxes of the triangles, grown by the margin the rasterizers may spill over
+void dirty_mark_triangles(const triangle_t* triangles, int num_triangles);
+void dirty_mark_all(void);
+
+// copies the background over the tiles drawn last frame, after which the color buffer is all background
+void background_restore(void);
+// copies the background over the whole color buffer
+void background_restore_all(void);
+// clears the depth of the tiles drawn this frame, the only ones the rasterizers test against
+void dirty_clear_z_buffer(void);
+// uploads the tiles drawn last frame or this one to color_buffer_texture and copies it to the renderer
+void render_dirty_color_buffer(void);
+
+#endif
@@ -0,0 +1,1093 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+#include "bench.h"
+#include "matrix.h"
+#include "transform.h"
+#include "display.h"
+#include "triangle.h"
+#include "rasterizer.h"
+#include "mesh.h"
+#include "obj.h"
+#include "array.h"
+#include "depth_sort.h"
+#include "mesh_optimize.h"
+#include "math_baseline.h"
+
+double bench_now_ms(void) {
+    return (double) SDL_GetPerformanceCounter() * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+int double_compare_function(const void* a, const void* b) {
+    double d1 = *(const double*) a;
+    double d2 = *(const double*) b;
+    return (d1 > d2) - (d1 < d2);
+}
+
+// nearest-rank percentile on an already sorted array
+double percentile(const double* sorted, int count, double p) {
+    int rank = (int) (p * count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+bench_stats_t bench_compute_stats(const double* frame_ms, int num_frames, long long total_triangles) {
+    bench_stats_t stats = { 0 };
+    if (num_frames <= 0) {
+        return stats;
+    }
+
+    // sort a copy so the caller keeps the per-frame order
+    double* sorted = (double*) malloc(sizeof(double) * num_frames);
+    memcpy(sorted, frame_ms, sizeof(double) * num_frames);
+    qsort(sorted, num_frames, sizeof(double), double_compare_function);
+
+    for (int i=0;i<num_frames;i++) {
+        stats.total_ms += frame_ms[i];
+    }
+
+    stats.num_frames = num_frames;
+    stats.min_ms = sorted[0];
+    stats.median_ms = percentile(sorted, num_frames, 0.50);
+    stats.p99_ms = percentile(sorted, num_frames, 0.99);
+    stats.mean_ms = stats.total_ms / num_frames;
+    stats.triangles_per_sec = stats.total_ms > 0 ? total_triangles / (stats.total_ms / 1000.0) : 0;
+
+    free(sorted);
+    return stats;
+}
+
+void bench_print_header(void) {
+    printf(
+        "%-28s %8s %10s %10s %10s %10s %14s %13s\n",
+        "scene", "frames", "min ms", "median ms", "p99 ms", "mean ms", "triangles/s", "allocs/frame"
+    );
+}
+
+void bench_print_stats(const char* name, bench_stats_t stats) {
+    printf(
+        "%-28s %8d %10.3f %10.3f %10.3f %10.3f %14.0f %13.2f\n",
+        name,
+        stats.num_frames,
+        stats.min_ms,
+        stats.median_ms,
+        stats.p99_ms,
+        stats.mean_ms,
+        stats.triangles_per_sec,
+        stats.allocations_per_frame
+    );
+}
+
+bool bench_reset_peak_rss(void) {
+#if defined(__linux__)
+    // writing 5 lowers the process's peak resident set (VmHWM) to its current one
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (!file) {
+        return false;
+    }
+    bool written = fputs("5", file) >= 0;
+    return fclose(file) == 0 && written;
+#else
+    return false;
+#endif
+}
+
+long bench_peak_rss_kb(void) {
+#if defined(__linux__)
+    // VmHWM is the peak bench_reset_peak_rss lowers, ru_maxrss keeps the peak of the whole run
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[256];
+        long peak_kb = -1;
+        while (peak_kb < 0 && fgets(line, sizeof(line), file)) {
+            sscanf(line, "VmHWM: %ld kB", &peak_kb);
+        }
+        fclose(file);
+        if (peak_kb >= 0) {
+            return peak_kb;
+        }
+    }
+#endif
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    // bytes there, kilobytes everywhere else
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+#define BENCH_RESULTS_HEADER "case,width,height,frames,mean_ms,median_ms,p99_ms,triangles_per_sec,pixels_per_sec,peak_rss_kb"
+
+bool bench_write_results(const char* filename, const bench_result_t* results, int num_results) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error opening %s.\n", filename);
+        return false;
+    }
+
+    fprintf(file, "%s\n", BENCH_RESULTS_HEADER);
+    for (int i=0; i<num_results; i++) {
+        const bench_result_t* result = &results[i];
+        fprintf(file, "%s,%d,%d,%d,%.4f,%.4f,%.4f,%.0f,%.0f,%ld\n",
+            result->name, result->width, result->height, result->stats.num_frames,
+            result->stats.mean_ms, result->stats.median_ms, result->stats.p99_ms,
+            result->stats.triangles_per_sec, result->pixels_per_sec, result->peak_rss_kb);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// reads a file written by bench_write_results into a growing array, NULL if it can't be opened
+bench_result_t* bench_read_results(const char* filename, int* num_results) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error opening %s.\n", filename);
+        return NULL;
+    }
+
+    bench_result_t* results = NULL;
+    int capacity = 0;
+    *num_results = 0;
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        bench_result_t result = { 0 };
+        // the header and anything else that isn't a full row is skipped
+        if (sscanf(line, "%63[^,],%d,%d,%d,%lf,%lf,%lf,%lf,%lf,%ld",
+            result.name, &result.width, &result.height, &result.stats.num_frames,
+            &result.stats.mean_ms, &result.stats.median_ms, &result.stats.p99_ms,
+            &result.stats.triangles_per_sec, &result.pixels_per_sec, &result.peak_rss_kb) != 10) {
+            continue;
+        }
+        if (*num_results == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            results = (bench_result_t*) realloc(results, sizeof(bench_result_t) * capacity);
+        }
+        results[(*num_results)++] = result;
+    }
+
+    fclose(file);
+    return results;
+}
+
+int bench_compare_results(const char* baseline_filename, const char* current_filename, double threshold) {
+    int num_baseline, num_current;
+    bench_result_t* baseline = bench_read_results(baseline_filename, &num_baseline);
+    bench_result_t* current = bench_read_results(current_filename, &num_current);
+    if (!baseline || !current) {
+        free(baseline);
+        free(current);
+        return -1;
+    }
+
+    printf("%-32s %12s %12s %8s %12s %12s %8s\n",
+        "case", "base ms", "ms", "change", "base rss kb", "rss kb", "change");
+
+    int regressions = 0;
+    for (int c=0; c<num_current; c++) {
+        const bench_result_t* now = &current[c];
+        const bench_result_t* before = NULL;
+        for (int b=0; b<num_baseline; b++) {
+            // a case only compares against the same case at the same resolution
+            if (strcmp(baseline[b].name, now->name) == 0 && baseline[b].width == now->width && baseline[b].height == now->height) {
+                before = &baseline[b];
+                break;
+            }
+        }
+        if (!before) {
+            printf("%-32s %12s %12.3f %8s   new case\n", now->name, "-", now->stats.median_ms, "-");
+            continue;
+        }
+
+        double ms_change = before->stats.median_ms > 0 ? now->stats.median_ms / before->stats.median_ms - 1 : 0;
+        double rss_change = before->peak_rss_kb > 0 ? (double) now->peak_rss_kb / before->peak_rss_kb - 1 : 0;
+        bool slower = ms_change > threshold;
+        bool bigger = rss_change > threshold;
+        regressions += slower || bigger;
+
+        printf("%-32s %12.3f %12.3f %+7.1f%% %12ld %12ld %+7.1f%%%s%s\n",
+            now->name, before->stats.median_ms, now->stats.median_ms, ms_change * 100,
+            before->peak_rss_kb, now->peak_rss_kb, rss_change * 100,
+            slower ? "   SLOWER" : "", bigger ? "   MORE MEMORY" : "");
+    }
+
+    printf("%d of %d cases regressed by more than %.1f%%\n", regressions, num_current, threshold * 100);
+
+    free(baseline);
+    free(current);
+    return regressions;
+}
+
+typedef void (*transform_kernel_t)(const mat4_t*, const mat4_t*, const vertex_soa_t*, vertex_stream_t*, float, float);
+
+void bench_vertex_transform(int num_vertices, int iterations) {
+    // deterministic cloud of points inside the unit cube
+    srand(1);
+    vec3_t* vertices = (vec3_t*) malloc(sizeof(vec3_t) * num_vertices);
+    for (int i=0; i<num_vertices; i++) {
+        vertices[i].x = rand() / (float) RAND_MAX * 2 - 1;
+        vertices[i].y = rand() / (float) RAND_MAX * 2 - 1;
+        vertices[i].z = rand() / (float) RAND_MAX * 2 - 1;
+    }
+
+    mat4_t world_matrix = mat4_mul_mat4(mat4_make_rotation_y(0.5), mat4_make_rotation_x(0.3));
+    world_matrix = mat4_mul_mat4(mat4_make_translation(0, 0, 5), world_matrix);
+    mat4_t projection_matrix = mat4_make_perspective(M_PI / 3, 1080 / 1920.0, 0.1, 100.0);
+    float half_width = 960;
+    float half_height = 540;
+
+    vertex_soa_t soa = { 0 };
+    vertex_soa_build(&soa, vertices, num_vertices);
+    vertex_stream_t reference = { 0 };
+    vertex_stream_t stream = { 0 };
+    vertex_stream_reserve(&reference, soa.padded_count);
+    vertex_stream_reserve(&stream, soa.padded_count);
+    transform_vertices_scalar(&world_matrix, &projection_matrix, &soa, &reference, half_width, half_height);
+
+    printf("vertex transform: %d vertices, %d iterations\n", num_vertices, iterations);
+    printf("%-12s %12s %14s %10s\n", "kernel", "ns/vertex", "Mvertices/s", "matches");
+
+    // the current per-vertex path: mat4_t by value, one vec4_t at a time
+    vec4_t* transformed = (vec4_t*) malloc(sizeof(vec4_t) * num_vertices);
+    vec2_t* projected = (vec2_t*) malloc(sizeof(vec2_t) * num_vertices);
+    double start = bench_now_ms();
+    for (int it=0; it<iterations; it++) {
+        for (int i=0; i<num_vertices; i++) {
+            transformed[i] = mat4_mul_vec4(projection_matrix, mat4_mul_vec4(world_matrix, vec4_from_vec3(vertices[i])));
+            projected[i].x = (transformed[i].x / transformed[i].w) * half_width + half_width;
+            projected[i].y = (transformed[i].y / transformed[i].w) * half_height + half_height;
+        }
+    }
+    double elapsed = bench_now_ms() - start;
+    bool matches = true;
+    for (int i=0; i<num_vertices; i++) {
+        matches = matches && projected[i].x == reference.screen_x[i] && projected[i].y == reference.screen_y[i];
+    }
+    printf("%-12s %12.3f %14.1f %10s\n", "per-vertex",
+        elapsed * 1e6 / ((double) num_vertices * iterations),
+        (double) num_vertices * iterations / (elapsed * 1000.0),
+        matches ? "yes" : "NO");
+
+    const char* names[3];
+    transform_kernel_t kernels[3];
+    int num_kernels = 0;
+    names[num_kernels] = "soa scalar";
+    kernels[num_kernels++] = transform_vertices_scalar;
+#if defined(__SSE__)
+    names[num_kernels] = "soa sse";
+    kernels[num_kernels++] = transform_vertices_sse;
+#endif
+#if defined(TRANSFORM_AVX_KERNEL)
+    if (SDL_HasAVX()) {
+        names[num_kernels] = "soa avx";
+        kernels[num_kernels++] = transform_vertices_avx;
+    }
+#endif
+
+    for (int k=0; k<num_kernels; k++) {
+        start = bench_now_ms();
+        for (int it=0; it<iterations; it++) {
+            kernels[k](&world_matrix, &projection_matrix, &soa, &stream, half_width, half_height);
+        }
+        elapsed = bench_now_ms() - start;
+
+        matches = memcmp(stream.screen_x, reference.screen_x, sizeof(float) * num_vertices) == 0 &&
+            memcmp(stream.screen_y, reference.screen_y, sizeof(float) * num_vertices) == 0 &&
+            memcmp(stream.z, reference.z, sizeof(float) * num_vertices) == 0 &&
+            memcmp(stream.clip_w, reference.clip_w, sizeof(float) * num_vertices) == 0;
+        printf("%-12s %12.3f %14.1f %10s\n", names[k],
+            elapsed * 1e6 / ((double) num_vertices * iterations),
+            (double) num_vertices * iterations / (elapsed * 1000.0),
+            matches ? "yes" : "NO");
+    }
+
+    free(transformed);
+    free(projected);
+    free(vertices);
+    vertex_soa_free(&soa);
+    vertex_stream_free(&reference);
+    vertex_stream_free(&stream);
+}
+
+void bench_fill_rate(int num_triangles) {
+    if (color_buffer == NULL) {
+        color_buffer = (uint32_t*) malloc(sizeof(uint32_t) * window_width * window_height);
+    }
+    if (z_buffer == NULL) {
+        z_buffer = (float*) malloc(sizeof(float) * window_width * window_height);
+    }
+
+    int sizes[] = { 8, 32, 128, 512 };
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    triangle_t* triangles = (triangle_t*) malloc(sizeof(triangle_t) * num_triangles);
+    clip_rect_t clip = screen_rect();
+
+    printf("fill rate: %dx%d, %d triangles per size\n", window_width, window_height, num_triangles);
+    printf("%-6s %-12s %-6s %12s %14s\n", "size", "filler", "depth", "Mtri/s", "Mpixels/s");
+
+    for (int s=0; s<num_sizes; s++) {
+        // random triangles that fit in a size x size box somewhere on the screen
+        srand(7);
+        double total_area = 0;
+        int size = sizes[s];
+        for (int i=0; i<num_triangles; i++) {
+            float ox = rand() % (window_width - size);
+            float oy = rand() % (window_height - size);
+            for (int j=0; j<3; j++) {
+                triangles[i].points[j].x = ox + rand() / (float) RAND_MAX * size;
+                triangles[i].points[j].y = oy + rand() / (float) RAND_MAX * size;
+                triangles[i].inv_w[j] = 0.1 + rand() / (float) RAND_MAX;
+            }
+            triangles[i].color = 0xFF000000 | (rand() & 0xFFFFFF);
+
+            vec2_t* p = triangles[i].points;
+            total_area += fabs((p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y)) / 2;
+        }
+
+        // fewer repetitions of the big ones
+        int count = num_triangles / (size / 8);
+
+        for (int filler=0; filler<2; filler++) {
+            for (int depth_test=0; depth_test<2; depth_test++) {
+                clear_color_buffer(0xFF000000);
+                clear_z_buffer();
+
+                double start = bench_now_ms();
+                for (int i=0; i<count; i++) {
+                    triangle_t* t = &triangles[i];
+                    if (filler == 1) {
+                        draw_filled_triangle_halfspace(t, depth_test, &clip);
+                    } else if (depth_test) {
+                        draw_filled_triangle_depth_clipped(t, &clip);
+                    } else {
+                        draw_filled_triangle_clipped(
+                            t->points[0].x, t->points[0].y,
+                            t->points[1].x, t->points[1].y,
+                            t->points[2].x, t->points[2].y,
+                            t->color,
+                            &clip
+                        );
+                    }
+                }
+                double elapsed = bench_now_ms() - start;
+
+                double pixels = total_area * count / num_triangles;
+                printf("%-6d %-12s %-6s %12.2f %14.1f\n",
+                    size,
+                    filler == 1 ? "half-space" : "scanline",
+                    depth_test ? "yes" : "no",
+                    count / (elapsed * 1000.0),
+                    pixels / (elapsed * 1000.0));
+            }
+        }
+    }
+
+    free(triangles);
+}
+
+// samples one window sized screen whose rows cross the texture at angle, scale level 0 texels apart,
+// returns the elapsed milliseconds and adds the texels to checksum so the loop can't be dropped
+double texture_walk(const texture_t* texture, int level, float angle, float scale, uint32_t* checksum) {
+    float width = texture->levels[0].width;
+    float height = texture->levels[0].height;
+    float du = cosf(angle) * scale / width;
+    float dv = sinf(angle) * scale / height;
+    uint32_t sum = 0;
+
+    double start = bench_now_ms();
+    for (int y=0; y<window_height; y++) {
+        // the next row is a step at right angles to this one
+        float u = -y * dv * height / width;
+        float v = y * du * width / height;
+        for (int x=0; x<window_width; x++) {
+            sum += texture_sample(texture, level, u, v);
+            u += du;
+            v += dv;
+        }
+    }
+    double elapsed = bench_now_ms() - start;
+
+    *checksum += sum;
+    return elapsed;
+}
+
+void bench_texture_sampling(int texture_size, int repetitions) {
+    if (color_buffer == NULL) {
+        color_buffer = (uint32_t*) malloc(sizeof(uint32_t) * window_width * window_height);
+    }
+    if (z_buffer == NULL) {
+        z_buffer = (float*) malloc(sizeof(float) * window_width * window_height);
+    }
+
+    texture_t textures[2] = { 0 };
+    texture_make_checker(&textures[0], texture_size, 8, TEXTURE_LINEAR);
+    texture_make_checker(&textures[1], texture_size, 8, TEXTURE_TILED);
+    char* layout_names[] = { "linear", "tiled" };
+    double pixels = (double) window_width * window_height * repetitions;
+    uint32_t checksums[2] = { 0, 0 };
+
+    printf("texture sampling: %dx%d screen, %dx%d texture, %d repetitions\n", window_width, window_height, texture_size, texture_size, repetitions);
+    printf("%-26s %-8s %14s\n", "walk", "layout", "Mtexels/s");
+
+    // 4 texels per pixel, from level 0 and from level 2 where the same walk is 1 texel per pixel
+    struct {
+        const char* name;
+        float angle;
+        float scale;
+        int level;
+    } walks[] = {
+        { "rows", 0, 1, 0 },
+        { "columns", (float) M_PI / 2, 1, 0 },
+        { "diagonal", (float) M_PI / 4, 1, 0 },
+        { "rotated 30", (float) M_PI / 6, 1, 0 },
+        { "minified 4x, level 0", (float) M_PI / 6, 4, 0 },
+        { "minified 4x, level 2", (float) M_PI / 6, 4, 2 }
+    };
+    int num_walks = sizeof(walks) / sizeof(walks[0]);
+
+    for (int w=0; w<num_walks; w++) {
+        for (int layout=0; layout<2; layout++) {
+            double elapsed = 0;
+            for (int r=0; r<repetitions; r++) {
+                elapsed += texture_walk(&textures[layout], walks[w].level, walks[w].angle, walks[w].scale, &checksums[layout]);
+            }
+            printf("%-26s %-8s %14.1f\n", walks[w].name, layout_names[layout], pixels / (elapsed * 1000.0));
+        }
+    }
+
+    // the real filler: two triangles covering the screen with the texture turned under them, 1 texel per pixel
+    clip_rect_t clip = screen_rect();
+    float angles[] = { 0, (float) M_PI / 6, (float) M_PI / 2 };
+    int num_angles = sizeof(angles) / sizeof(angles[0]);
+    for (int a=0; a<num_angles; a++) {
+        vec2_t corners[4] = { { 0, 0 }, { window_width, 0 }, { window_width, window_height }, { 0, window_height } };
+        tex2_t texcoords[4];
+        float c = cosf(angles[a]), s = sinf(angles[a]);
+        for (int i=0; i<4; i++) {
+            texcoords[i].u = (corners[i].x * c - corners[i].y * s) / texture_size;
+            texcoords[i].v = (corners[i].x * s + corners[i].y * c) / texture_size;
+        }
+        triangle_t quad[2] = {
+            { .points = { corners[0], corners[1], corners[2] }, .inv_w = { 1, 1, 1 }, .texcoords = { texcoords[0], texcoords[1], texcoords[2] } },
+            { .points = { corners[0], corners[2], corners[3] }, .inv_w = { 1, 1, 1 }, .texcoords = { texcoords[0], texcoords[2], texcoords[3] } }
+        };
+
+        for (int layout=0; layout<2; layout++) {
+            double start = bench_now_ms();
+            for (int r=0; r<repetitions; r++) {
+                draw_textured_triangle(&quad[0], &textures[layout], false, &clip);
+                draw_textured_triangle(&quad[1], &textures[layout], false, &clip);
+            }
+            double elapsed = bench_now_ms() - start;
+
+            char name[32];
+            snprintf(name, sizeof(name), "filler, rotated %d", (int) roundf(angles[a] * 180 / (float) M_PI));
+            printf("%-26s %-8s %14.1f\n", name, layout_names[layout], pixels / (elapsed * 1000.0));
+        }
+    }
+
+    if (checksums[0] != checksums[1]) {
+        printf("the layouts sampled different texels\n");
+    }
+
+    texture_free(&textures[0]);
+    texture_free(&textures[1]);
+}
+
+void bench_line_rate(int num_lines) {
+    if (color_buffer == NULL) {
+        color_buffer = (uint32_t*) malloc(sizeof(uint32_t) * window_width * window_height);
+    }
+
+    // line length, and how far past the screen the end points may be placed
+    int lengths[] = { 16, 128, 1024, 4096 };
+    int spreads[] = { 0, 0, 0, 8 };
+    char* names[] = { "16px", "128px", "1024px", "offscreen" };
+    int num_kinds = sizeof(lengths) / sizeof(lengths[0]);
+
+    int* coords = (int*) malloc(sizeof(int) * 4 * num_lines);
+    clip_rect_t clip = screen_rect();
+
+    printf("line rate: %dx%d, %d lines per kind\n", window_width, window_height, num_lines);
+    printf("%-10s %-10s %14s\n", "kind", "rasterizer", "Mlines/s");
+
+    for (int kind=0; kind<num_kinds; kind++) {
+        srand(11);
+        int spread = spreads[kind] * (window_width > window_height ? window_width : window_height);
+        for (int i=0; i<num_lines; i++) {
+            int* c = &coords[4 * i];
+            if (spread > 0) {
+                // long lines that mostly lie off-screen
+                c[0] = rand() % (2 * spread) - spread;
+                c[1] = rand() % (2 * spread) - spread;
+                c[2] = rand() % (2 * spread) - spread;
+                c[3] = rand() % (2 * spread) - spread;
+            } else {
+                c[0] = rand() % window_width;
+                c[1] = rand() % window_height;
+                c[2] = c[0] + rand() % (2 * lengths[kind] + 1) - lengths[kind];
+                c[3] = c[1] + rand() % (2 * lengths[kind] + 1) - lengths[kind];
+            }
+        }
+
+        for (int rasterizer=0; rasterizer<2; rasterizer++) {
+            double start = bench_now_ms();
+            for (int i=0; i<num_lines; i++) {
+                int* c = &coords[4 * i];
+                if (rasterizer == 0) {
+                    draw_line_dda_clipped(c[0], c[1], c[2], c[3], 0xFFFFFFFF, &clip);
+                } else {
+                    draw_line_clipped(c[0], c[1], c[2], c[3], 0xFFFFFFFF, &clip);
+                }
+            }
+            double elapsed = bench_now_ms() - start;
+
+            printf("%-10s %-10s %14.2f\n", names[kind], rasterizer == 0 ? "dda" : "integer", num_lines / (elapsed * 1000.0));
+        }
+    }
+
+    free(coords);
+}
+
+// writes a uv sphere as an obj file, returns false if the file can't be created
+bool write_synthetic_obj(const char* filename, int num_vertices) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        return false;
+    }
+
+    int rings = (int) sqrt(num_vertices / 2.0);
+    int segments = num_vertices / (rings > 0 ? rings : 1);
+    rings = rings < 2 ? 2 : rings;
+    segments = segments < 3 ? 3 : segments;
+
+    fprintf(file, "# synthetic sphere, %d rings, %d segments\n", rings, segments);
+    for (int r=0; r<rings; r++) {
+        double theta = M_PI * (r + 0.5) / rings;
+        for (int s=0; s<segments; s++) {
+            double phi = 2 * M_PI * s / segments;
+            fprintf(file, "v %f %f %f\n", sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+        }
+    }
+    for (int r=0; r+1<rings; r++) {
+        for (int s=0; s<segments; s++) {
+            int a = r * segments + s + 1;
+            int b = r * segments + (s + 1) % segments + 1;
+            int c = a + segments;
+            int d = b + segments;
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, c, c, c, b, b, b);
+            fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", b, b, b, c, c, c, d, d, d);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+long long file_size(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// every loader in the load benchmark fills this mesh
+mesh_t loaded_mesh = { 0 };
+
+enum obj_loader {
+    OBJ_LOADER_STDIO,
+    OBJ_LOADER_PARSER,
+    OBJ_LOADER_CACHE
+};
+
+// best of several loads, so small files aren't dominated by a cold first run
+double time_obj_load(char* filename, enum obj_loader loader) {
+    double best_ms = -1;
+    double total_ms = 0;
+    for (int run=0; run<3 || total_ms < 200; run++) {
+        double start = bench_now_ms();
+        if (loader == OBJ_LOADER_STDIO) {
+            load_obj_file_data_stdio(&loaded_mesh, filename);
+        } else if (loader == OBJ_LOADER_PARSER) {
+            obj_load(filename, &loaded_mesh.vertices, &loaded_mesh.faces);
+        } else {
+            load_obj_file_data(&loaded_mesh, filename);
+        }
+        double elapsed = bench_now_ms() - start;
+        free_mesh_data(&loaded_mesh);
+
+        total_ms += elapsed;
+        if (best_ms < 0 || elapsed < best_ms) {
+            best_ms = elapsed;
+        }
+    }
+    return best_ms;
+}
+
+// loaded_mesh holds the same vertices and faces
+bool mesh_geometry_matches(const vec3_t* vertices, const face_t* faces) {
+    bool matches = array_length((void*) vertices) == array_length(loaded_mesh.vertices) &&
+        array_length((void*) faces) == array_length(loaded_mesh.faces);
+    for (int i=0; matches && i<array_length(loaded_mesh.vertices); i++) {
+        matches = vertices[i].x == loaded_mesh.vertices[i].x && vertices[i].y == loaded_mesh.vertices[i].y && vertices[i].z == loaded_mesh.vertices[i].z;
+    }
+    for (int i=0; matches && i<array_length(loaded_mesh.faces); i++) {
+        matches = faces[i].a == loaded_mesh.faces[i].a && faces[i].b == loaded_mesh.faces[i].b && faces[i].c == loaded_mesh.faces[i].c;
+    }
+    return matches;
+}
+
+// the fgets loader produces the same geometry as the parser, the cached load the same as the parser plus the
+// optimization pass and the meshlet face order
+bool obj_loaders_match(char* filename) {
+    vec3_t* vertices = NULL;
+    face_t* faces = NULL;
+    obj_load(filename, &vertices, &faces);
+
+    load_obj_file_data_stdio(&loaded_mesh, filename);
+    bool matches = mesh_geometry_matches(vertices, faces);
+    free_mesh_data(&loaded_mesh);
+
+    optimize_mesh(&vertices, &faces, NULL);
+    array_free(build_meshlets(vertices, faces));
+    load_obj_file_data(&loaded_mesh, filename);
+    matches = matches && loaded_mesh.cache.base != NULL && mesh_geometry_matches(vertices, faces);
+    free_mesh_data(&loaded_mesh);
+
+    array_free(vertices);
+    array_free(faces);
+    return matches;
+}
+
+void bench_obj_load(char** filenames, int num_files, int synthetic_vertices) {
+    char* synthetic_filename = "bench_synthetic.obj";
+    bool has_synthetic = synthetic_vertices > 0 && write_synthetic_obj(synthetic_filename, synthetic_vertices);
+
+    printf("obj load: %d threads available\n", SDL_GetCPUCount());
+    printf("%-22s %8s %10s %10s %10s %10s %10s %10s %10s %8s\n", "file", "MB", "fgets ms", "MB/s", "mmap ms", "MB/s", "first ms", "cache ms", "MB/s", "matches");
+
+    for (int f=0; f<num_files + (has_synthetic ? 1 : 0); f++) {
+        char* filename = f < num_files ? filenames[f] : synthetic_filename;
+        long long size = file_size(filename);
+        if (size < 0) {
+            printf("%-22s missing\n", filename);
+            continue;
+        }
+
+        double mb = size / (1024.0 * 1024.0);
+        double stdio_ms = time_obj_load(filename, OBJ_LOADER_STDIO);
+        double mmap_ms = time_obj_load(filename, OBJ_LOADER_PARSER);
+        // the first load parses, optimizes, simplifies and writes the cache, every later one maps it
+        char cache_filename[1024];
+        snprintf(cache_filename, sizeof(cache_filename), "%s%s", filename, MESH_CACHE_EXTENSION);
+        remove(cache_filename);
+        double first_start = bench_now_ms();
+        load_obj_file_data(&loaded_mesh, filename);
+        double first_ms = bench_now_ms() - first_start;
+        free_mesh_data(&loaded_mesh);
+        double cache_ms = time_obj_load(filename, OBJ_LOADER_CACHE);
+        bool matches = obj_loaders_match(filename);
+
+        // MB/s is always relative to the .obj size, so the columns compare directly
+        printf("%-22s %8.2f %10.3f %10.1f %10.3f %10.1f %10.3f %10.3f %10.1f %8s\n", filename, mb,
+            stdio_ms, mb / (stdio_ms / 1000.0),
+            mmap_ms, mb / (mmap_ms / 1000.0),
+            first_ms, cache_ms, mb / (cache_ms / 1000.0),
+            matches ? "yes" : "NO");
+    }
+
+    if (has_synthetic) {
+        char cache_filename[1024];
+        snprintf(cache_filename, sizeof(cache_filename), "%s%s", synthetic_filename, MESH_CACHE_EXTENSION);
+        remove(synthetic_filename);
+        remove(cache_filename);
+    }
+}
+
+// the comparator update() used to sort with, kept as the baseline
+int triangle_compare_function(const void* a, const void* b) {
+    triangle_t* t1 = (triangle_t*) a;
+    triangle_t* t2 = (triangle_t*) b;
+    return t2->avg_depth - t1->avg_depth;
+}
+
+// fills avg_depth of every triangle for one frame of an animation
+typedef void (*depth_scene_t)(triangle_t* triangles, int count, int frame, void* data);
+
+typedef struct {
+    vec3_t* vertices;
+    face_t* faces;
+} depth_scene_mesh_t;
+
+// the mesh spinning in front of the camera like in update()
+void depth_scene_rotating_mesh(triangle_t* triangles, int count, int frame, void* data) {
+    depth_scene_mesh_t* scene = (depth_scene_mesh_t*) data;
+    mat4_t world_matrix = mat4_mul_mat4(mat4_make_rotation_y(0.01 * frame), mat4_make_rotation_x(0.01 * frame));
+    world_matrix = mat4_mul_mat4(mat4_make_translation(0, 0, 5), world_matrix);
+
+    for (int i=0; i<count; i++) {
+        face_t face = scene->faces[i];
+        float depth = 0;
+        int corners[3] = { face.a, face.b, face.c };
+        for (int j=0; j<3; j++) {
+            depth += mat4_mul_vec4(world_matrix, vec4_from_vec3(scene->vertices[corners[j]])).z;
+        }
+        triangles[i].avg_depth = depth / 3.0;
+    }
+}
+
+// random depths that each drift a little every frame
+void depth_scene_random_drift(triangle_t* triangles, int count, int frame, void* data) {
+    const float* base = (const float*) data;
+    for (int i=0; i<count; i++) {
+        triangles[i].avg_depth = base[i] + 0.002 * sinf(0.1 * frame + i);
+    }
+}
+
+// fresh random depths every frame, the worst case for the coherent sort
+void depth_scene_random_shuffle(triangle_t* triangles, int count, int frame, void* data) {
+    for (int i=0; i<count; i++) {
+        triangles[i].avg_depth = 1 + rand() / (float) RAND_MAX * 99;
+    }
+}
+
+bool is_sorted_far_to_near(const triangle_t* triangles, int count) {
+    for (int i=1; i<count; i++) {
+        if (triangles[i].avg_depth > triangles[i - 1].avg_depth) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void bench_depth_sort_scene(const char* name, depth_scene_t scene, void* data, int count, int num_frames) {
+    triangle_t* triangles = (triangle_t*) calloc(count, sizeof(triangle_t));
+    triangle_t* sorted = (triangle_t*) calloc(count, sizeof(triangle_t));
+    int* face_ids = (int*) malloc(sizeof(int) * count);
+    for (int i=0; i<count; i++) {
+        face_ids[i] = i;
+    }
+
+    char* methods[] = { "qsort", "radix", "coherent" };
+    for (int method=0; method<3; method++) {
+        depth_sorter_t sorter = { 0 };
+        double total_ms = 0;
+        bool sorted_ok = true;
+
+        for (int frame=0; frame<num_frames; frame++) {
+            scene(triangles, count, frame, data);
+
+            // every method ends with the triangles themselves in order, like update() needs them
+            double start = bench_now_ms();
+            const triangle_t* result = triangles;
+            if (method == 0) {
+                qsort(triangles, count, sizeof(triangle_t), triangle_compare_function);
+            } else {
+                const depth_key_t* order = depth_sorter_sort(&sorter, triangles, face_ids, count, count, method == 2);
+                for (int k=0; k<count; k++) {
+                    sorted[k] = triangles[order[k].index];
+                }
+                result = sorted;
+            }
+            total_ms += bench_now_ms() - start;
+
+            sorted_ok = sorted_ok && is_sorted_far_to_near(result, count);
+        }
+
+        printf("%-10s %10d %-10s %12.3f %10s %10d\n", name, count, methods[method],
+            total_ms / num_frames, sorted_ok ? "yes" : "no", sorter.num_fallbacks);
+        depth_sorter_free(&sorter);
+    }
+
+    free(triangles);
+    free(sorted);
+    free(face_ids);
+}
+
+void bench_depth_sort(char* teapot_filename, int synthetic_triangles, int num_frames) {
+    printf("depth sort: %d frames per scene\n", num_frames);
+    printf("%-10s %10s %-10s %12s %10s %10s\n", "scene", "triangles", "method", "ms/frame", "sorted", "fallbacks");
+
+    depth_scene_mesh_t teapot = { NULL, NULL };
+    if (obj_load(teapot_filename, &teapot.vertices, &teapot.faces) && array_length(teapot.faces) > 0) {
+        bench_depth_sort_scene("teapot", depth_scene_rotating_mesh, &teapot, array_length(teapot.faces), num_frames);
+    } else {
+        printf("%-10s missing\n", teapot_filename);
+    }
+    array_free(teapot.vertices);
+    array_free(teapot.faces);
+
+    srand(5);
+    float* base = (float*) malloc(sizeof(float) * synthetic_triangles);
+    for (int i=0; i<synthetic_triangles; i++) {
+        base[i] = 1 + rand() / (float) RAND_MAX * 99;
+    }
+    bench_depth_sort_scene("drift", depth_scene_random_drift, base, synthetic_triangles, num_frames);
+    bench_depth_sort_scene("shuffle", depth_scene_random_shuffle, NULL, synthetic_triangles, num_frames);
+    free(base);
+}
+
+// bytes a mesh keeps around: the arrays, their soa copy and the stream it is transformed into every frame
+long long mesh_memory_bytes(int num_vertices, int num_faces) {
+    long long padded = (num_vertices + TRANSFORM_BATCH - 1) / TRANSFORM_BATCH * TRANSFORM_BATCH;
+    return (long long) sizeof(vec3_t) * num_vertices + (long long) sizeof(face_t) * num_faces +
+        sizeof(float) * 3 * padded + sizeof(float) * 9 * padded;
+}
+
+// ms per frame of the vertex work in update(): transform every vertex, then gather the corners of every face
+double time_mesh_transform(vec3_t* vertices, const face_t* faces, int iterations) {
+    int num_vertices = array_length(vertices);
+    int num_faces = array_length((void*) faces);
+    mat4_t world_matrix = mat4_mul_mat4(mat4_make_rotation_y(0.5), mat4_make_rotation_x(0.3));
+    world_matrix = mat4_mul_mat4(mat4_make_translation(0, 0, 5), world_matrix);
+    mat4_t projection_matrix = mat4_make_perspective(M_PI / 3, 1080 / 1920.0, 0.1, 100.0);
+
+    vertex_soa_t soa = { 0 };
+    vertex_soa_build(&soa, vertices, num_vertices);
+    vertex_stream_t stream = { 0 };
+    vertex_stream_reserve(&stream, soa.padded_count);
+
+    volatile float sink = 0;
+    double best_ms = -1;
+    for (int it=0; it<iterations; it++) {
+        double start = bench_now_ms();
+        transform_vertices(&world_matrix, &projection_matrix, &soa, &stream, 960, 540);
+        float depth = 0;
+        int front_facing = 0;
+        for (int i=0; i<num_faces; i++) {
+            int a = faces[i].a, b = faces[i].b, c = faces[i].c;
+            float area = (stream.screen_x[b] - stream.screen_x[a]) * (stream.screen_y[c] - stream.screen_y[a]) -
+                (stream.screen_y[b] - stream.screen_y[a]) * (stream.screen_x[c] - stream.screen_x[a]);
+            front_facing += area <= 0;
+            depth += stream.z[a] + stream.z[b] + stream.z[c];
+        }
+        double elapsed = bench_now_ms() - start;
+        sink += depth + front_facing;
+
+        if (best_ms < 0 || elapsed < best_ms) {
+            best_ms = elapsed;
+        }
+    }
+
+    vertex_soa_free(&soa);
+    vertex_stream_free(&stream);
+    return best_ms;
+}
+
+void bench_mesh_optimize_mesh(const char* name, vec3_t* vertices, face_t* faces, int iterations) {
+    int num_vertices = array_length(vertices);
+    int num_faces = array_length(faces);
+    vec3_t* optimized_vertices = (vec3_t*) array_hold(NULL, num_vertices, sizeof(vec3_t));
+    face_t* optimized_faces = (face_t*) array_hold(NULL, num_faces, sizeof(face_t));
+    memcpy(optimized_vertices, vertices, sizeof(vec3_t) * num_vertices);
+    memcpy(optimized_faces, faces, sizeof(face_t) * num_faces);
+
+    mesh_optimize_stats_t stats;
+    double start = bench_now_ms();
+    optimize_mesh(&optimized_vertices, &optimized_faces, &stats);
+    double optimize_ms = bench_now_ms() - start;
+
+    long long bytes_before = mesh_memory_bytes(stats.vertices_before, stats.faces_before);
+    long long bytes_after = mesh_memory_bytes(stats.vertices_after, stats.faces_after);
+    double frame_before = time_mesh_transform(vertices, faces, iterations);
+    double frame_after = time_mesh_transform(optimized_vertices, optimized_faces, iterations);
+
+    printf("%-18s %9d %9d %8d %8d %6d %6d %10.1f %10.1f %10.2f %10.3f %10.3f\n", name,
+        stats.vertices_before, stats.vertices_after,
+        stats.faces_before, stats.faces_after,
+        stats.degenerate_faces, stats.duplicate_faces,
+        bytes_before / 1024.0, bytes_after / 1024.0,
+        optimize_ms, frame_before, frame_after);
+
+    array_free(optimized_vertices);
+    array_free(optimized_faces);
+}
+
+void bench_mesh_optimize(char** filenames, int num_files, int synthetic_vertices, int iterations) {
+    printf("mesh optimization: best of %d frames, transform and face gather\n", iterations);
+    printf("%-18s %9s %9s %8s %8s %6s %6s %10s %10s %10s %10s %10s\n", "mesh", "vertices", "after", "faces", "after",
+        "degen", "dupes", "KB", "after", "opt ms", "frame ms", "after");
+
+    for (int f=0; f<num_files; f++) {
+        vec3_t* vertices = NULL;
+        face_t* faces = NULL;
+        if (!obj_load(filenames[f], &vertices, &faces) || array_length(faces) == 0) {
+            printf("%-18s missing\n", filenames[f]);
+        } else {
+            const char* name = strrchr(filenames[f], '/');
+            bench_mesh_optimize_mesh(name ? name + 1 : filenames[f], vertices, faces, iterations);
+        }
+        array_free(vertices);
+        array_free(faces);
+    }
+
+    // a mesh big enough to leave the caches, once as generated and once in the order a careless exporter might write
+    char* synthetic_filename = "bench_optimize.obj";
+    vec3_t* vertices = NULL;
+    face_t* faces = NULL;
+    if (synthetic_vertices > 0 && write_synthetic_obj(synthetic_filename, synthetic_vertices) &&
+        obj_load(synthetic_filename, &vertices, &faces)) {
+        bench_mesh_optimize_mesh("sphere", vertices, faces, iterations);
+
+        srand(7);
+        int num_faces = array_length(faces);
+        for (int i=num_faces - 1; i>0; i--) {
+            int j = rand() % (i + 1);
+            face_t swap = faces[i];
+            faces[i] = faces[j];
+            faces[j] = swap;
+        }
+        bench_mesh_optimize_mesh("sphere shuffled", vertices, faces, iterations);
+    }
+    array_free(vertices);
+    array_free(faces);
+    remove(synthetic_filename);
+}
+
+// inputs per kernel, small enough to stay in L1 so the numbers are about the math
+#define BENCH_MATH_COUNT 1024
+
+// times body over every input, iterations times, in ns per call
+#define BENCH_MATH_LOOP(ns, body)                                             \
+    do {                                                                      \
+        double start = bench_now_ms();                                        \
+        for (int it=0; it<iterations; it++) {                                 \
+            for (int i=0; i<BENCH_MATH_COUNT; i++) {                          \
+                body;                                                         \
+            }                                                                 \
+        }                                                                     \
+        (ns) = (bench_now_ms() - start) * 1e6 / ((double) iterations * BENCH_MATH_COUNT); \
+    } while (0)
+
+float mat4_max_difference(const mat4_t* a, const mat4_t* b) {
+    float largest = 0;
+    for (int i=0; i<4; i++) {
+        for (int j=0; j<4; j++) {
+            largest = fmaxf(largest, fabsf(a->m[i][j] - b->m[i][j]));
+        }
+    }
+    return largest;
+}
+
+void bench_print_math(const char* kernel, double before_ns, double after_ns, float max_difference) {
+    printf("%-22s %12.2f %12.2f %9.2fx %12g\n", kernel, before_ns, after_ns, before_ns / after_ns, max_difference);
+}
+
+void bench_math_kernels(int iterations) {
+    srand(3);
+    vec3_t* a = (vec3_t*) malloc(sizeof(vec3_t) * BENCH_MATH_COUNT);
+    vec3_t* b = (vec3_t*) malloc(sizeof(vec3_t) * BENCH_MATH_COUNT);
+    vec3_t* out3 = (vec3_t*) malloc(sizeof(vec3_t) * BENCH_MATH_COUNT);
+    vec3_t* ref3 = (vec3_t*) malloc(sizeof(vec3_t) * BENCH_MATH_COUNT);
+    vec4_t* v4 = (vec4_t*) malloc(sizeof(vec4_t) * BENCH_MATH_COUNT);
+    vec4_t* out4 = (vec4_t*) malloc(sizeof(vec4_t) * BENCH_MATH_COUNT);
+    vec4_t* ref4 = (vec4_t*) malloc(sizeof(vec4_t) * BENCH_MATH_COUNT);
+    mat4_t* m = (mat4_t*) malloc(sizeof(mat4_t) * BENCH_MATH_COUNT);
+    mat4_t* outm = (mat4_t*) malloc(sizeof(mat4_t) * BENCH_MATH_COUNT);
+    mat4_t* refm = (mat4_t*) malloc(sizeof(mat4_t) * BENCH_MATH_COUNT);
+    float* angles = (float*) malloc(sizeof(float) * BENCH_MATH_COUNT);
+
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        a[i] = (vec3_t){ rand() / (float) RAND_MAX * 2 - 1, rand() / (float) RAND_MAX * 2 - 1, rand() / (float) RAND_MAX * 2 - 1 };
+        b[i] = (vec3_t){ rand() / (float) RAND_MAX * 2 - 1, rand() / (float) RAND_MAX * 2 - 1, rand() / (float) RAND_MAX * 2 - 1 };
+        v4[i] = vec4_from_vec3(a[i]);
+        angles[i] = rand() / (float) RAND_MAX * 2 * M_PI;
+        m[i] = mat4_make_world(a[i], b[i], (vec3_t){ angles[i], 0, 5 });
+    }
+
+    printf("math kernels: %d inputs, %d iterations, before = out-of-line by value with double trig\n", BENCH_MATH_COUNT, iterations);
+    printf("%-22s %12s %12s %10s %12s\n", "kernel", "before ns", "after ns", "speedup", "max diff");
+
+    double before_ns, after_ns;
+    float difference;
+
+    BENCH_MATH_LOOP(before_ns, ref3[i] = baseline_vec3_cross(a[i], b[i]));
+    BENCH_MATH_LOOP(after_ns, vec3_cross_into(&out3[i], &a[i], &b[i]));
+    difference = 0;
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        difference = fmaxf(difference, vec3_length(vec3_sub(out3[i], ref3[i])));
+    }
+    bench_print_math("vec3_cross", before_ns, after_ns, difference);
+
+    BENCH_MATH_LOOP(before_ns, ref3[i] = a[i]; baseline_vec3_normalize(&ref3[i]));
+    BENCH_MATH_LOOP(after_ns, out3[i] = a[i]; vec3_normalize(&out3[i]));
+    difference = 0;
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        difference = fmaxf(difference, vec3_length(vec3_sub(out3[i], ref3[i])));
+    }
+    bench_print_math("vec3_normalize", before_ns, after_ns, difference);
+
+    BENCH_MATH_LOOP(before_ns, ref3[i] = baseline_vec3_rotate_y(a[i], angles[i]));
+    BENCH_MATH_LOOP(after_ns, out3[i] = vec3_rotate_y(a[i], angles[i]));
+    difference = 0;
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        difference = fmaxf(difference, vec3_length(vec3_sub(out3[i], ref3[i])));
+    }
+    bench_print_math("vec3_rotate_y", before_ns, after_ns, difference);
+
+    BENCH_MATH_LOOP(before_ns, ref4[i] = baseline_mat4_mul_vec4(m[i], v4[i]));
+    BENCH_MATH_LOOP(after_ns, mat4_mul_vec4_into(&out4[i], &m[i], &v4[i]));
+    difference = 0;
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        difference = fmaxf(difference, fabsf(out4[i].x - ref4[i].x) + fabsf(out4[i].y - ref4[i].y) + fabsf(out4[i].z - ref4[i].z) + fabsf(out4[i].w - ref4[i].w));
+    }
+    bench_print_math("mat4_mul_vec4", before_ns, after_ns, difference);
+
+    BENCH_MATH_LOOP(before_ns, refm[i] = baseline_mat4_mul_mat4(m[i], m[(i + 1) % BENCH_MATH_COUNT]));
+    BENCH_MATH_LOOP(after_ns, mat4_mul_mat4_into(&outm[i], &m[i], &m[(i + 1) % BENCH_MATH_COUNT]));
+    difference = 0;
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        difference = fmaxf(difference, mat4_max_difference(&outm[i], &refm[i]));
+    }
+    bench_print_math("mat4_mul_mat4", before_ns, after_ns, difference);
+
+    // what scene_update_world_matrices did per instance against the fused builder
+    BENCH_MATH_LOOP(before_ns,
+        refm[i] = baseline_mat4_make_scale(a[i].x, a[i].y, a[i].z);
+        refm[i] = baseline_mat4_mul_mat4(baseline_mat4_make_rotation_x(b[i].x), refm[i]);
+        refm[i] = baseline_mat4_mul_mat4(baseline_mat4_make_rotation_y(b[i].y), refm[i]);
+        refm[i] = baseline_mat4_mul_mat4(baseline_mat4_make_rotation_z(b[i].z), refm[i]);
+        refm[i] = baseline_mat4_mul_mat4(baseline_mat4_make_translation(angles[i], 0, 5), refm[i]));
+    BENCH_MATH_LOOP(after_ns, outm[i] = mat4_make_world(a[i], b[i], (vec3_t){ angles[i], 0, 5 }));
+    difference = 0;
+    for (int i=0; i<BENCH_MATH_COUNT; i++) {
+        difference = fmaxf(difference, mat4_max_difference(&outm[i], &refm[i]));
+    }
+    bench_print_math("world matrix", before_ns, after_ns, difference);
+
+    free(a);
+    free(b);
+    free(out3);
+    free(ref3);
+    free(v4);
+    free(out4);
+    free(ref4);
+    free(m);
+    free(outm);
+    free(refm);
+    free(angles);
+}
@@ -0,0 +1,78 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+
+// aggregate timings over a run of frames
+typedef struct {
+    int num_frames;
+    double min_ms;
+    double median_ms;
+    double p99_ms;
+    double mean_ms;
+    double total_ms;
+    double triangles_per_sec;
+    double allocations_per_frame;   // heap allocations per frame after the first, filled in by the caller
+} bench_stats_t;
+
+// one case of the benchmark suite, a row of its results file
+typedef struct {
+    char name[64];
+    int width;
+    int height;
+    bench_stats_t stats;
+    double pixels_per_sec;          // frame buffer pixels delivered, width * height per frame
+    long peak_rss_kb;               // of the process during the case, where bench_reset_peak_rss can't start a new peak
+                                    // how much the case raised the peak of the whole run; 0 where it can't be read
+} bench_result_t;
+
+// high resolution wall clock in milliseconds
+double bench_now_ms(void);
+
+bench_stats_t bench_compute_stats(const double* frame_ms, int num_frames, long long total_triangles);
+void bench_print_header(void);
+void bench_print_stats(const char* name, bench_stats_t stats);
+
+// starts a new peak resident set for bench_peak_rss_kb (linux), false where it can't
+bool bench_reset_peak_rss(void);
+// peak resident set of the process since bench_reset_peak_rss, or over the whole run where that can't reset it
+long bench_peak_rss_kb(void);
+
+// the suite's results as csv with a header line, false if the file can't be written
+bool bench_write_results(const char* filename, const bench_result_t* results, int num_results);
+// compares two results files case by case, a case regresses when its median frame time or peak rss
+// grew by more than threshold (0.05 is 5%), returns the number of regressions or -1 if a file can't be read
+int bench_compare_results(const char* baseline_filename, const char* current_filename, double threshold);
+
+// compares the per-vertex aos transform with the soa kernels
+void bench_vertex_transform(int num_vertices, int iterations);
+
+// ns per call of the vector and matrix kernels, against the out-of-line versions they replaced,
+// with the largest difference between the results
+void bench_math_kernels(int iterations);
+
+// compares the scanline and half-space triangle fillers on random triangles of several sizes
+// draws into the current color_buffer/z_buffer, allocating them if needed
+void bench_fill_rate(int num_triangles);
+
+// texels per second of nearest sampling from the linear and the tiled layout, walking a texture too big
+// for the caches at several angles and scales the way rows of screen pixels do, then through the textured filler
+// draws into the current color_buffer/z_buffer, allocating them if needed
+void bench_texture_sampling(int texture_size, int repetitions);
+
+// compares the float DDA line with the clipped integer line rasterizer
+void bench_line_rate(int num_lines);
+
+// load throughput of the mmap/parallel obj loader against the fgets/sscanf one,
+// on the given files plus a generated sphere with synthetic_vertices vertices
+void bench_obj_load(char** filenames, int num_files, int synthetic_vertices);
+
+// welding, face filtering and locality ordering: counts, memory and per-frame transform time before and after,
+// on the given files plus a generated sphere with synthetic_vertices vertices, as generated and with shuffled faces
+void bench_mesh_optimize(char** filenames, int num_files, int synthetic_vertices, int iterations);
+
+// painter's sort: qsort on triangles against the radix and the frame-coherent depth sorts,
+// on the rotating teapot and on synthetic_triangles animated random depths
+void bench_depth_sort(char* teapot_filename, int synthetic_triangles, int num_frames);
+
+#endif
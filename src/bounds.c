@@ -0,0 +1,145 @@
+#include <math.h>
+#include <float.h>
+#include "bounds.h"
+
+aabb_t aabb_empty(void) {
+    aabb_t box = {
+        .min = { FLT_MAX, FLT_MAX, FLT_MAX },
+        .max = { -FLT_MAX, -FLT_MAX, -FLT_MAX }
+    };
+    return box;
+}
+
+aabb_t aabb_from_points(const vec3_t* points, int count) {
+    aabb_t box = aabb_empty();
+    for (int i=0; i<count; i++) {
+        box.min.x = fminf(box.min.x, points[i].x);
+        box.min.y = fminf(box.min.y, points[i].y);
+        box.min.z = fminf(box.min.z, points[i].z);
+        box.max.x = fmaxf(box.max.x, points[i].x);
+        box.max.y = fmaxf(box.max.y, points[i].y);
+        box.max.z = fmaxf(box.max.z, points[i].z);
+    }
+    return box;
+}
+
+aabb_t aabb_union(aabb_t a, aabb_t b) {
+    aabb_t box = {
+        .min = { fminf(a.min.x, b.min.x), fminf(a.min.y, b.min.y), fminf(a.min.z, b.min.z) },
+        .max = { fmaxf(a.max.x, b.max.x), fmaxf(a.max.y, b.max.y), fmaxf(a.max.z, b.max.z) }
+    };
+    return box;
+}
+
+vec3_t aabb_center(aabb_t box) {
+    return vec3_mul(vec3_add(box.min, box.max), 0.5);
+}
+
+aabb_t aabb_transform(aabb_t box, const mat4_t* m) {
+    // transform the center, then every axis of the half extent adds |m| times itself
+    // (Arvo, "Transforming axis-aligned bounding boxes")
+    vec3_t center = aabb_center(box);
+    vec3_t extent = vec3_mul(vec3_sub(box.max, box.min), 0.5);
+
+    float c[3];
+    float e[3];
+    for (int i=0; i<3; i++) {
+        c[i] = m->m[i][0] * center.x + m->m[i][1] * center.y + m->m[i][2] * center.z + m->m[i][3];
+        e[i] = fabsf(m->m[i][0]) * extent.x + fabsf(m->m[i][1]) * extent.y + fabsf(m->m[i][2]) * extent.z;
+    }
+
+    aabb_t result = {
+        .min = { c[0] - e[0], c[1] - e[1], c[2] - e[2] },
+        .max = { c[0] + e[0], c[1] + e[1], c[2] + e[2] }
+    };
+    return result;
+}
+
+bounding_sphere_t bounding_sphere_from_points(const vec3_t* points, int count, aabb_t box) {
+    bounding_sphere_t sphere = { .center = aabb_center(box), .radius = 0 };
+    for (int i=0; i<count; i++) {
+        float distance = vec3_length(vec3_sub(points[i], sphere.center));
+        sphere.radius = fmaxf(sphere.radius, distance);
+    }
+    return sphere;
+}
+
+bounding_sphere_t bounding_sphere_transform(bounding_sphere_t sphere, const mat4_t* m) {
+    vec4_t center = mat4_mul_vec4(*m, vec4_from_vec3(sphere.center));
+
+    // the length of each column is the scale along that axis
+    float max_scale = 0;
+    for (int j=0; j<3; j++) {
+        vec3_t column = { m->m[0][j], m->m[1][j], m->m[2][j] };
+        max_scale = fmaxf(max_scale, vec3_length(column));
+    }
+
+    bounding_sphere_t result = { .center = vec3_from_vec4(center), .radius = sphere.radius * max_scale };
+    return result;
+}
+
+vec4_t normalize_plane(vec4_t plane) {
+    float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    vec4_t normalized = { plane.x / length, plane.y / length, plane.z / length, plane.w / length };
+    return normalized;
+}
+
+frustum_t frustum_from_projection(const mat4_t* projection) {
+    // clip = projection * v, so each clip space inequality is a combination of projection rows
+    vec4_t rows[4];
+    for (int i=0; i<4; i++) {
+        rows[i] = (vec4_t){ projection->m[i][0], projection->m[i][1], projection->m[i][2], projection->m[i][3] };
+    }
+
+    frustum_t frustum;
+    for (int axis=0; axis<2; axis++) {
+        vec4_t r = rows[axis];
+        vec4_t w = rows[3];
+        frustum.planes[axis * 2] = normalize_plane((vec4_t){ w.x + r.x, w.y + r.y, w.z + r.z, w.w + r.w });
+        frustum.planes[axis * 2 + 1] = normalize_plane((vec4_t){ w.x - r.x, w.y - r.y, w.z - r.z, w.w - r.w });
+    }
+    // near: z >= 0, far: z <= w
+    frustum.planes[4] = normalize_plane(rows[2]);
+    frustum.planes[5] = normalize_plane((vec4_t){
+        rows[3].x - rows[2].x, rows[3].y - rows[2].y, rows[3].z - rows[2].z, rows[3].w - rows[2].w
+    });
+    return frustum;
+}
+
+enum frustum_test frustum_test_aabb(const frustum_t* frustum, aabb_t box) {
+    enum frustum_test result = FRUSTUM_INSIDE;
+    for (int i=0; i<6; i++) {
+        vec4_t plane = frustum->planes[i];
+
+        // the corner furthest along the plane normal, and the one furthest against it
+        vec3_t positive = {
+            plane.x >= 0 ? box.max.x : box.min.x,
+            plane.y >= 0 ? box.max.y : box.min.y,
+            plane.z >= 0 ? box.max.z : box.min.z
+        };
+        vec3_t negative = {
+            plane.x >= 0 ? box.min.x : box.max.x,
+            plane.y >= 0 ? box.min.y : box.max.y,
+            plane.z >= 0 ? box.min.z : box.max.z
+        };
+
+        if (plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0) {
+            return FRUSTUM_OUTSIDE;
+        }
+        if (plane.x * negative.x + plane.y * negative.y + plane.z * negative.z + plane.w < 0) {
+            result = FRUSTUM_INTERSECTS;
+        }
+    }
+    return result;
+}
+
+bool frustum_sphere_visible(const frustum_t* frustum, bounding_sphere_t sphere) {
+    for (int i=0; i<6; i++) {
+        vec4_t plane = frustum->planes[i];
+        float distance = plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w;
+        if (distance < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
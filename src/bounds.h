@@ -0,0 +1,47 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <stdbool.h>
+#include "vector.h"
+#include "matrix.h"
+
+typedef struct {
+    vec3_t min;
+    vec3_t max;
+} aabb_t;
+
+typedef struct {
+    vec3_t center;
+    float radius;
+} bounding_sphere_t;
+
+// the six planes of a view frustum, normalized, inside is where dot(plane, point) + w >= 0
+typedef struct {
+    vec4_t planes[6];
+} frustum_t;
+
+enum frustum_test {
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECTS,
+    FRUSTUM_INSIDE
+};
+
+// an empty box, any point added to it becomes the box
+aabb_t aabb_empty(void);
+aabb_t aabb_from_points(const vec3_t* points, int count);
+aabb_t aabb_union(aabb_t a, aabb_t b);
+vec3_t aabb_center(aabb_t box);
+// box around the transformed box, exact for the rotated corners and no bigger than that
+aabb_t aabb_transform(aabb_t box, const mat4_t* m);
+
+// centered on the box, just big enough for every point
+bounding_sphere_t bounding_sphere_from_points(const vec3_t* points, int count, aabb_t box);
+// the sphere scaled by the largest scale of m, so it stays conservative under non-uniform scaling
+bounding_sphere_t bounding_sphere_transform(bounding_sphere_t sphere, const mat4_t* m);
+
+// the planes of clip space (-w <= x, y <= w, 0 <= z <= w) pulled back through the projection
+frustum_t frustum_from_projection(const mat4_t* projection);
+enum frustum_test frustum_test_aabb(const frustum_t* frustum, aabb_t box);
+bool frustum_sphere_visible(const frustum_t* frustum, bounding_sphere_t sphere);
+
+#endif
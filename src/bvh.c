@@ -0,0 +1,170 @@
+#include "bvh.h"
+
+// deep enough for any tree bvh_build makes, it halves the item count at every level
+#define BVH_MAX_DEPTH 64
+
+float centroid_axis(const aabb_t* box, int axis) {
+    vec3_t center = aabb_center(*box);
+    return axis == 0 ? center.x : (axis == 1 ? center.y : center.z);
+}
+
+// reorders indices so the k-th one is in place along axis, smaller ones before it, larger ones after
+void select_kth(int* indices, int count, int k, const aabb_t* item_bounds, int axis) {
+    int low = 0;
+    int high = count - 1;
+    while (low < high) {
+        float pivot = centroid_axis(&item_bounds[indices[(low + high) / 2]], axis);
+        int i = low;
+        int j = high;
+        while (i <= j) {
+            while (centroid_axis(&item_bounds[indices[i]], axis) < pivot) i++;
+            while (centroid_axis(&item_bounds[indices[j]], axis) > pivot) j--;
+            if (i <= j) {
+                int swap = indices[i];
+                indices[i] = indices[j];
+                indices[j] = swap;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) {
+            high = j;
+        } else if (k >= i) {
+            low = i;
+        } else {
+            return;
+        }
+    }
+}
+
+int build_node(bvh_t* bvh, const aabb_t* item_bounds, int first, int count) {
+    int* indices = bvh->indices.items + first;
+
+    aabb_t bounds = aabb_empty();
+    aabb_t centers = aabb_empty();
+    for (int i=0; i<count; i++) {
+        bounds = aabb_union(bounds, item_bounds[indices[i]]);
+        vec3_t center = aabb_center(item_bounds[indices[i]]);
+        centers = aabb_union(centers, (aabb_t){ center, center });
+    }
+
+    int node_index = (int) bvh->nodes.length;
+    bvh_node_t node = { .bounds = bounds, .offset = first, .count = count };
+    dynarray_push(&bvh->nodes, node);
+
+    if (count <= BVH_LEAF_SIZE) {
+        return node_index;
+    }
+
+    vec3_t extent = vec3_sub(centers.max, centers.min);
+    int axis = 0;
+    if (extent.y > extent.x && extent.y >= extent.z) {
+        axis = 1;
+    } else if (extent.z > extent.x && extent.z > extent.y) {
+        axis = 2;
+    }
+
+    // median split, so the depth stays logarithmic however the items are spread
+    int half = count / 2;
+    select_kth(indices, count, half, item_bounds, axis);
+
+    build_node(bvh, item_bounds, first, half);
+    int right = build_node(bvh, item_bounds, first + half, count - half);
+
+    // the push may have moved the nodes
+    bvh->nodes.items[node_index].offset = right;
+    bvh->nodes.items[node_index].count = 0;
+    return node_index;
+}
+
+void bvh_build(bvh_t* bvh, const aabb_t* item_bounds, int count) {
+    dynarray_clear(&bvh->nodes);
+    dynarray_reserve(&bvh->indices, (size_t) count);
+    bvh->indices.length = count;
+    for (int i=0; i<count; i++) {
+        bvh->indices.items[i] = i;
+    }
+
+    if (count > 0) {
+        // a binary tree over n / BVH_LEAF_SIZE leaves
+        dynarray_reserve(&bvh->nodes, (size_t) (2 * (count / BVH_LEAF_SIZE) + 1));
+        build_node(bvh, item_bounds, 0, count);
+    }
+}
+
+void bvh_refit(bvh_t* bvh, const aabb_t* item_bounds) {
+    // children come after their parent, so walking backwards sees them first
+    for (size_t n=bvh->nodes.length; n-- > 0;) {
+        bvh_node_t* node = &bvh->nodes.items[n];
+        if (node->count > 0) {
+            aabb_t bounds = aabb_empty();
+            for (int i=0; i<node->count; i++) {
+                bounds = aabb_union(bounds, item_bounds[bvh->indices.items[node->offset + i]]);
+            }
+            node->bounds = bounds;
+        } else {
+            node->bounds = aabb_union(bvh->nodes.items[n + 1].bounds, bvh->nodes.items[node->offset].bounds);
+        }
+    }
+}
+
+// every item under node, without testing anything
+void append_subtree(const bvh_t* bvh, int node_index, bvh_index_list_t* visible) {
+    // the items of a subtree are one contiguous run: from its leftmost leaf to its rightmost one
+    int first = node_index;
+    while (bvh->nodes.items[first].count == 0) {
+        first++;
+    }
+    int last = node_index;
+    while (bvh->nodes.items[last].count == 0) {
+        last = bvh->nodes.items[last].offset;
+    }
+
+    const bvh_node_t* first_leaf = &bvh->nodes.items[first];
+    const bvh_node_t* last_leaf = &bvh->nodes.items[last];
+    for (int i=first_leaf->offset; i<last_leaf->offset + last_leaf->count; i++) {
+        dynarray_push(visible, bvh->indices.items[i]);
+    }
+}
+
+void bvh_cull(const bvh_t* bvh, const frustum_t* frustum, const aabb_t* item_bounds, const bounding_sphere_t* item_spheres, bvh_index_list_t* visible) {
+    if (bvh->nodes.length == 0) {
+        return;
+    }
+
+    int stack[BVH_MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        int node_index = stack[--top];
+        const bvh_node_t* node = &bvh->nodes.items[node_index];
+
+        enum frustum_test test = frustum_test_aabb(frustum, node->bounds);
+        if (test == FRUSTUM_OUTSIDE) {
+            continue;
+        }
+        if (test == FRUSTUM_INSIDE) {
+            append_subtree(bvh, node_index, visible);
+            continue;
+        }
+
+        if (node->count == 0) {
+            stack[top++] = node->offset;
+            stack[top++] = node_index + 1;
+            continue;
+        }
+
+        for (int i=0; i<node->count; i++) {
+            int item = bvh->indices.items[node->offset + i];
+            if (frustum_test_aabb(frustum, item_bounds[item]) != FRUSTUM_OUTSIDE && frustum_sphere_visible(frustum, item_spheres[item])) {
+                dynarray_push(visible, item);
+            }
+        }
+    }
+}
+
+void bvh_free(bvh_t* bvh) {
+    dynarray_free(&bvh->nodes);
+    dynarray_free(&bvh->indices);
+}
@@ -0,0 +1,35 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "bounds.h"
+#include "dynarray.h"
+
+// a leaf holds at most this many items
+#define BVH_LEAF_SIZE 4
+
+// nodes are stored depth first, so an interior node's left child is the next node
+typedef struct {
+    aabb_t bounds;
+    int offset;     // leaf: first slot in indices, interior: index of the right child
+    int count;      // items in a leaf, 0 for interior nodes
+} bvh_node_t;
+
+typedef DYNARRAY(int) bvh_index_list_t;
+
+// bounding volume hierarchy over a set of boxes, the items are only referred to by index
+typedef struct {
+    DYNARRAY(bvh_node_t) nodes;
+    bvh_index_list_t indices;   // item indices, each leaf owns a contiguous run
+} bvh_t;
+
+// top down, splitting each node at the middle of its item centers along the longest axis
+void bvh_build(bvh_t* bvh, const aabb_t* item_bounds, int count);
+// recomputes the node boxes after the items moved, the tree shape stays, so it gets looser as they move further
+void bvh_refit(bvh_t* bvh, const aabb_t* item_bounds);
+// appends every item that may be inside the frustum to visible
+// subtrees entirely outside are skipped, ones entirely inside are taken without further tests,
+// items of leaves crossing a plane are also tested against their sphere
+void bvh_cull(const bvh_t* bvh, const frustum_t* frustum, const aabb_t* item_bounds, const bounding_sphere_t* item_spheres, bvh_index_list_t* visible);
+void bvh_free(bvh_t* bvh);
+
+#endif
@@ -0,0 +1,116 @@
+#include "clipping.h"
+
+uint16_t clip_outcode(float x, float y, float z, float w) {
+    uint16_t code = 0;
+
+    if (x < -w) code |= OUTSIDE_LEFT;
+    if (x > w) code |= OUTSIDE_RIGHT;
+    if (y < -w) code |= OUTSIDE_BOTTOM;
+    if (y > w) code |= OUTSIDE_TOP;
+    if (z < 0) code |= OUTSIDE_NEAR;
+    if (z > w) code |= OUTSIDE_FAR;
+
+    float guard_w = CLIP_GUARD_BAND * w;
+    if (x < -guard_w) code |= OUTSIDE_GUARD_LEFT;
+    if (x > guard_w) code |= OUTSIDE_GUARD_RIGHT;
+    if (y < -guard_w) code |= OUTSIDE_GUARD_BOTTOM;
+    if (y > guard_w) code |= OUTSIDE_GUARD_TOP;
+
+    return code;
+}
+
+polygon_t polygon_from_triangle(vec4_t v0, vec4_t v1, vec4_t v2, tex2_t t0, tex2_t t1, tex2_t t2) {
+    polygon_t polygon = {
+        .vertices = { v0, v1, v2 },
+        .texcoords = { t0, t1, t2 },
+        .num_vertices = 3
+    };
+    return polygon;
+}
+
+// signed distance to a plane, inside is >= 0
+float plane_distance(uint16_t plane, vec4_t v) {
+    switch (plane) {
+        case OUTSIDE_NEAR: return v.z;
+        case OUTSIDE_FAR: return v.w - v.z;
+        case OUTSIDE_GUARD_LEFT: return CLIP_GUARD_BAND * v.w + v.x;
+        case OUTSIDE_GUARD_RIGHT: return CLIP_GUARD_BAND * v.w - v.x;
+        case OUTSIDE_GUARD_BOTTOM: return CLIP_GUARD_BAND * v.w + v.y;
+        case OUTSIDE_GUARD_TOP: return CLIP_GUARD_BAND * v.w - v.y;
+    }
+    return 0;
+}
+
+tex2_t tex2_lerp(tex2_t a, tex2_t b, float t) {
+    tex2_t result = {
+        .u = a.u + (b.u - a.u) * t,
+        .v = a.v + (b.v - a.v) * t
+    };
+    return result;
+}
+
+// sutherland-hodgman against a single plane
+void clip_polygon_against_plane(polygon_t* polygon, uint16_t plane) {
+    vec4_t inside_vertices[MAX_NUM_POLYGON_VERTICES];
+    tex2_t inside_texcoords[MAX_NUM_POLYGON_VERTICES];
+    int num_inside_vertices = 0;
+
+    vec4_t previous = polygon->vertices[polygon->num_vertices - 1];
+    tex2_t previous_texcoord = polygon->texcoords[polygon->num_vertices - 1];
+    float previous_distance = plane_distance(plane, previous);
+
+    for (int i=0; i<polygon->num_vertices; i++) {
+        vec4_t current = polygon->vertices[i];
+        tex2_t current_texcoord = polygon->texcoords[i];
+        float current_distance = plane_distance(plane, current);
+
+        if ((previous_distance >= 0) != (current_distance >= 0)) {
+            // always interpolate from the inside end, so the two triangles sharing
+            // this edge (which walk it in opposite directions) get the exact same point
+            if (previous_distance >= 0) {
+                float t = previous_distance / (previous_distance - current_distance);
+                inside_vertices[num_inside_vertices] = vec4_lerp(previous, current, t);
+                inside_texcoords[num_inside_vertices++] = tex2_lerp(previous_texcoord, current_texcoord, t);
+            } else {
+                float t = current_distance / (current_distance - previous_distance);
+                inside_vertices[num_inside_vertices] = vec4_lerp(current, previous, t);
+                inside_texcoords[num_inside_vertices++] = tex2_lerp(current_texcoord, previous_texcoord, t);
+            }
+        }
+
+        if (current_distance >= 0) {
+            inside_vertices[num_inside_vertices] = current;
+            inside_texcoords[num_inside_vertices++] = current_texcoord;
+        }
+
+        previous = current;
+        previous_texcoord = current_texcoord;
+        previous_distance = current_distance;
+    }
+
+    for (int i=0; i<num_inside_vertices; i++) {
+        polygon->vertices[i] = inside_vertices[i];
+        polygon->texcoords[i] = inside_texcoords[i];
+    }
+    polygon->num_vertices = num_inside_vertices;
+}
+
+void clip_polygon(polygon_t* polygon, uint16_t outcodes) {
+    // near first, every later plane can then rely on w > 0
+    static const uint16_t planes[] = {
+        OUTSIDE_NEAR, OUTSIDE_FAR,
+        OUTSIDE_GUARD_LEFT, OUTSIDE_GUARD_RIGHT,
+        OUTSIDE_GUARD_BOTTOM, OUTSIDE_GUARD_TOP
+    };
+
+    for (int p=0; p<6; p++) {
+        if (!(outcodes & planes[p])) {
+            continue;
+        }
+        clip_polygon_against_plane(polygon, planes[p]);
+        if (polygon->num_vertices < 3) {
+            polygon->num_vertices = 0;
+            return;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef CLIPPING_H
+#define CLIPPING_H
+
+#include <stdint.h>
+#include "vector.h"
+#include "texture.h"
+
+// x and y are only clipped once they leave the viewport by this factor,
+// closer than that the rasterizers' own screen clipping is cheaper than splitting the polygon
+#define CLIP_GUARD_BAND 2.0f
+
+// a triangle clipped by the 6 planes gains at most one vertex per plane
+#define MAX_NUM_POLYGON_VERTICES 9
+
+// outcode bits, the first 6 test the view frustum, the rest the guard band
+enum {
+    OUTSIDE_LEFT = 1 << 0,
+    OUTSIDE_RIGHT = 1 << 1,
+    OUTSIDE_BOTTOM = 1 << 2,
+    OUTSIDE_TOP = 1 << 3,
+    OUTSIDE_NEAR = 1 << 4,
+    OUTSIDE_FAR = 1 << 5,
+    OUTSIDE_GUARD_LEFT = 1 << 6,
+    OUTSIDE_GUARD_RIGHT = 1 << 7,
+    OUTSIDE_GUARD_BOTTOM = 1 << 8,
+    OUTSIDE_GUARD_TOP = 1 << 9
+};
+
+#define OUTSIDE_FRUSTUM (OUTSIDE_LEFT | OUTSIDE_RIGHT | OUTSIDE_BOTTOM | OUTSIDE_TOP | OUTSIDE_NEAR | OUTSIDE_FAR)
+// the planes clip_polygon actually clips against
+#define OUTSIDE_CLIP_PLANES (OUTSIDE_NEAR | OUTSIDE_FAR | OUTSIDE_GUARD_LEFT | OUTSIDE_GUARD_RIGHT | OUTSIDE_GUARD_BOTTOM | OUTSIDE_GUARD_TOP)
+
+// attributes are linear in clip space, so the texture coordinates are interpolated like the positions
+typedef struct {
+    vec4_t vertices[MAX_NUM_POLYGON_VERTICES];
+    tex2_t texcoords[MAX_NUM_POLYGON_VERTICES];
+    int num_vertices;
+} polygon_t;
+
+// which planes a clip space position is outside of
+// a triangle whose outcodes share a frustum bit is invisible,
+// one whose outcodes have no clip plane bit can be drawn without clipping
+uint16_t clip_outcode(float x, float y, float z, float w);
+
+polygon_t polygon_from_triangle(vec4_t v0, vec4_t v1, vec4_t v2, tex2_t t0, tex2_t t1, tex2_t t2);
+
+// clips against the planes in outcodes (the union of the vertex outcodes) in homogeneous clip space
+// the polygon stays convex, it is empty when nothing is left
+void clip_polygon(polygon_t* polygon, uint16_t outcodes);
+
+#endif
@@ -0,0 +1,209 @@
+#include <string.h>
+#include "depth_sort.h"
+
+uint32_t depth_sort_key(float depth) {
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+
+    // flipping the sign bit of positives and every bit of negatives
+    // makes the unsigned order match the float order
+    uint32_t ascending = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    // the painter's algorithm draws the farthest first
+    return ~ascending;
+}
+
+void depth_sort_radix(depth_key_t* keys, depth_key_t* scratch, size_t count) {
+    if (count < 2) {
+        return;
+    }
+
+    // one read of the keys fills the histograms of all four passes
+    size_t histograms[4][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i=0; i<count; i++) {
+        uint32_t key = keys[i].key;
+        histograms[0][key & 0xFF]++;
+        histograms[1][(key >> 8) & 0xFF]++;
+        histograms[2][(key >> 16) & 0xFF]++;
+        histograms[3][key >> 24]++;
+    }
+
+    depth_key_t* source = keys;
+    depth_key_t* destination = scratch;
+
+    for (int pass=0; pass<4; pass++) {
+        int shift = pass * 8;
+        size_t* histogram = histograms[pass];
+
+        // depths in a narrow range share their high bytes, those passes would only copy
+        if (histogram[(source[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        size_t offsets[256];
+        size_t offset = 0;
+        for (int b=0; b<256; b++) {
+            offsets[b] = offset;
+            offset += histogram[b];
+        }
+
+        for (size_t i=0; i<count; i++) {
+            destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+
+        depth_key_t* swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != keys) {
+        memcpy(keys, source, sizeof(depth_key_t) * count);
+    }
+}
+
+// stable insertion sort that stops after budget moves, the keys stay a permutation either way
+bool insertion_sort_bounded(depth_key_t* keys, size_t count, size_t budget) {
+    size_t moves = 0;
+    for (size_t i=1; i<count; i++) {
+        depth_key_t current = keys[i];
+        size_t j = i;
+        while (j > 0 && keys[j - 1].key > current.key) {
+            keys[j] = keys[j - 1];
+            j--;
+            if (++moves > budget) {
+                keys[j] = current;
+                return false;
+            }
+        }
+        keys[j] = current;
+    }
+    return true;
+}
+
+const depth_key_t* depth_sorter_sort(depth_sorter_t* sorter, const triangle_t* triangles, const int* face_ids, size_t count, int num_faces, bool coherent) {
+    // everything is reserved on the first call with some headroom, so switching to the coherent path
+    // doesn't allocate and neither does a frame where a few more faces turn visible
+    size_t reserve = count > sorter->keys.capacity ? count + count / 2 : count;
+    dynarray_reserve(&sorter->keys, reserve);
+    dynarray_reserve(&sorter->scratch, reserve);
+    dynarray_reserve(&sorter->previous_faces, reserve);
+    dynarray_reserve(&sorter->previous_order, reserve);
+    dynarray_reserve(&sorter->submitted_faces, reserve);
+    dynarray_reserve(&sorter->face_head, (size_t) num_faces);
+    dynarray_reserve(&sorter->triangle_next, reserve);
+    depth_key_t* keys = sorter->keys.items;
+    sorter->keys.length = count;
+
+    // a scene that keeps failing the insertion pass (fast motion, a camera cut) is radix sorted
+    // for a while before trying again, so the wasted passes stay rare
+    bool try_coherent = coherent && sorter->previous_faces.length > 0 && sorter->skip_coherent == 0;
+    if (sorter->skip_coherent > 0) {
+        sorter->skip_coherent--;
+    }
+
+    if (try_coherent) {
+        // keys in submission order first, the gathers below then read 8 bytes per triangle
+        // instead of a whole triangle_t at a random address
+        depth_key_t* submitted = sorter->scratch.items;
+        for (size_t i=0; i<count; i++) {
+            submitted[i].key = depth_sort_key(triangles[i].avg_depth);
+            submitted[i].index = (uint32_t) i;
+        }
+
+        bool same_triangles = count == sorter->submitted_faces.length &&
+            memcmp(face_ids, sorter->submitted_faces.items, sizeof(int) * count) == 0;
+
+        if (same_triangles) {
+            // nothing was culled or clipped differently, last frame's order applies as is
+            const int* previous_order = sorter->previous_order.items;
+            for (size_t k=0; k<count; k++) {
+                keys[k] = submitted[previous_order[k]];
+            }
+        } else {
+            int* head = sorter->face_head.items;
+            int* next = sorter->triangle_next.items;
+            const int* previous = sorter->previous_faces.items;
+            size_t num_previous = sorter->previous_faces.length;
+
+            // touch only the faces seen in either frame, unless that's most of the table anyway
+            if (num_previous + count >= (size_t) num_faces / 4) {
+                memset(head, 0xFF, sizeof(int) * num_faces);
+            } else {
+                for (size_t p=0; p<num_previous; p++) {
+                    if (previous[p] < num_faces) {
+                        head[previous[p]] = -1;
+                    }
+                }
+                for (size_t i=0; i<count; i++) {
+                    head[face_ids[i]] = -1;
+                }
+            }
+
+            // per face list of its triangles, in submission order
+            for (size_t i=count; i-- > 0;) {
+                next[i] = head[face_ids[i]];
+                head[face_ids[i]] = (int) i;
+            }
+
+            // faces in last frame's order first, then the ones that just became visible
+            size_t n = 0;
+            for (size_t p=0; p<num_previous; p++) {
+                int face = previous[p];
+                if (face >= num_faces) {
+                    continue;
+                }
+                for (int i=head[face]; i != -1; i=next[i]) {
+                    keys[n++] = submitted[i];
+                }
+                head[face] = -1;
+            }
+            for (size_t t=0; t<count; t++) {
+                int face = face_ids[t];
+                for (int i=head[face]; i != -1; i=next[i]) {
+                    keys[n++] = submitted[i];
+                }
+                head[face] = -1;
+            }
+        }
+
+        if (insertion_sort_bounded(keys, count, count * DEPTH_SORT_MOVE_BUDGET)) {
+            sorter->backoff = 0;
+        } else {
+            sorter->num_fallbacks++;
+            sorter->backoff = sorter->backoff == 0 ? 1 : sorter->backoff * 2;
+            sorter->backoff = sorter->backoff > DEPTH_SORT_MAX_BACKOFF ? DEPTH_SORT_MAX_BACKOFF : sorter->backoff;
+            sorter->skip_coherent = sorter->backoff;
+            depth_sort_radix(keys, sorter->scratch.items, count);
+        }
+    } else {
+        for (size_t i=0; i<count; i++) {
+            keys[i].key = depth_sort_key(triangles[i].avg_depth);
+            keys[i].index = (uint32_t) i;
+        }
+        depth_sort_radix(keys, sorter->scratch.items, count);
+    }
+
+    for (size_t k=0; k<count; k++) {
+        sorter->previous_faces.items[k] = face_ids[keys[k].index];
+        sorter->previous_order.items[k] = (int) keys[k].index;
+    }
+    sorter->previous_faces.length = count;
+    sorter->previous_order.length = count;
+    memcpy(sorter->submitted_faces.items, face_ids, sizeof(int) * count);
+    sorter->submitted_faces.length = count;
+
+    return keys;
+}
+
+void depth_sorter_free(depth_sorter_t* sorter) {
+    dynarray_free(&sorter->keys);
+    dynarray_free(&sorter->scratch);
+    dynarray_free(&sorter->previous_faces);
+    dynarray_free(&sorter->previous_order);
+    dynarray_free(&sorter->submitted_faces);
+    dynarray_free(&sorter->face_head);
+    dynarray_free(&sorter->triangle_next);
+    sorter->num_fallbacks = 0;
+    sorter->skip_coherent = 0;
+    sorter->backoff = 0;
+}
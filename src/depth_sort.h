@@ -0,0 +1,49 @@
+#ifndef DEPTH_SORT_H
+#define DEPTH_SORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "triangle.h"
+#include "dynarray.h"
+
+// compact sort element, key orders far to near
+typedef struct {
+    uint32_t key;
+    uint32_t index;     // into the triangle list the keys were built from
+} depth_key_t;
+
+// the insertion pass over last frame's order gives up after this many moves per triangle
+#define DEPTH_SORT_MOVE_BUDGET 4
+// after a failed insertion pass the next ones are skipped for up to this many frames
+#define DEPTH_SORT_MAX_BACKOFF 32
+
+// maps a depth to a key whose unsigned order is far to near
+uint32_t depth_sort_key(float depth);
+
+// stable lsd radix sort on key, 8 bits per pass, passes where every key has the same byte are skipped
+// the result ends up in keys, scratch must hold count elements
+void depth_sort_radix(depth_key_t* keys, depth_key_t* scratch, size_t count);
+
+// keeps last frame's order around so an animated scene, which is nearly sorted already,
+// only needs an insertion pass to fix it up
+typedef struct {
+    DYNARRAY(depth_key_t) keys;
+    DYNARRAY(depth_key_t) scratch;
+    DYNARRAY(int) previous_faces;   // face of every triangle in last frame's sorted order
+    DYNARRAY(int) previous_order;   // last frame's sorted triangle indices
+    DYNARRAY(int) submitted_faces;  // last frame's face_ids, to spot an unchanged triangle list
+    DYNARRAY(int) face_head;        // first triangle of each face this frame, -1 if none left
+    DYNARRAY(int) triangle_next;    // next triangle of the same face
+    int num_fallbacks;              // coherent sorts that ran out of budget and were radix sorted
+    int skip_coherent;              // frames left before the next coherent attempt
+    int backoff;                    // doubles with every fallback in a row
+} depth_sorter_t;
+
+// sorts the triangles far to near, face_ids[i] is the mesh face triangle i came from
+// with coherent set the previous call's order is the starting point, ties keep that order
+// the result is valid until the next call
+const depth_key_t* depth_sorter_sort(depth_sorter_t* sorter, const triangle_t* triangles, const int* face_ids, size_t count, int num_faces, bool coherent);
+void depth_sorter_free(depth_sorter_t* sorter);
+
+#endif
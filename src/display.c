@@ -1,14 +1,38 @@
 #include "display.h"
+#include "profiler.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// lines are drawn on top of the surface they belong to, so they win depth ties by this factor
+#define LINE_DEPTH_BIAS 1.01f
+
+// lines with end points further out than this are not drawn
+#define LINE_GUARD_BAND (1 << 28)
+
+// pixels past the end of every row of the headless texture, so its pitch differs from the width like a
+// streaming texture's can
+#define HEADLESS_TEXTURE_PADDING 16
 
 int window_width = 800;
 int window_height = 600;
+int display_width = 800;
+int display_height = 600;
 
 SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 
 uint32_t* color_buffer = NULL;
+int color_buffer_pitch = 0;
+float* z_buffer = NULL;
 SDL_Texture* color_buffer_texture = NULL;
+// color_buffer's own memory while it points into the locked texture
+uint32_t* unlocked_color_buffer = NULL;
+// stands in for color_buffer_texture when headless, so both present paths run and count their copies
+uint32_t* headless_texture = NULL;
+int headless_texture_pitch = 0;
+
+bool is_headless = false;
 
 bool initialize_window(void) {
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
@@ -22,6 +46,9 @@ bool initialize_window(void) {
 
     window_height = display_mode.h;
     window_width = display_mode.w;
+    display_width = window_width;
+    display_height = window_height;
+    color_buffer_pitch = window_width;
 
     // create an SDL window
     window = SDL_CreateWindow(
@@ -51,11 +78,83 @@ bool initialize_window(void) {
     }
 
     SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
+    // frames rendered below the display size are stretched bilinearly
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 
     return true;
 }
 
+// sets up an offscreen target of the given size
+// no window, renderer or texture is created, so nothing here touches the video subsystem
+bool initialize_headless(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "Invalid headless resolution %dx%d.\n", width, height);
+        return false;
+    }
+
+    window_width = width;
+    window_height = height;
+    display_width = width;
+    display_height = height;
+    color_buffer_pitch = width;
+    is_headless = true;
+
+    return true;
+}
+
+bool set_render_scale(float scale) {
+    int width = (int) (display_width * scale + 0.5f);
+    int height = (int) (display_height * scale + 0.5f);
+    width = width < 1 ? 1 : width > display_width ? display_width : width;
+    height = height < 1 ? 1 : height > display_height ? display_height : height;
+    if (width == window_width && height == window_height) {
+        return false;
+    }
+
+    window_width = width;
+    window_height = height;
+    color_buffer_pitch = width;
+    return true;
+}
+
+bool create_color_buffer_texture(void) {
+    if (is_headless) {
+        headless_texture_pitch = display_width + HEADLESS_TEXTURE_PADDING;
+        headless_texture = (uint32_t*) malloc(sizeof(uint32_t) * headless_texture_pitch * display_height);
+        if (!headless_texture) {
+            return false;
+        }
+        // a locked texture's contents are undefined, anything the frame fails to draw shows up in magenta
+        for (int i=0; i<headless_texture_pitch * display_height; i++) {
+            headless_texture[i] = 0xFFFF00FF;
+        }
+        return true;
+    }
+
+    color_buffer_texture = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        display_width,
+        display_height
+    );
+    return color_buffer_texture != NULL;
+}
+
+void destroy_color_buffer_texture(void) {
+    free(headless_texture);
+    headless_texture = NULL;
+    if (color_buffer_texture) {
+        SDL_DestroyTexture(color_buffer_texture);
+        color_buffer_texture = NULL;
+    }
+}
+
 void destroy_window(void) {
+    destroy_color_buffer_texture();
+    if (is_headless) {
+        return;
+    }
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -73,23 +172,191 @@ void draw_grid(void) {
 
 inline void draw_pixel(int x, int y, uint32_t color) {
     if (x >= 0 && x < window_width && y >= 0 && y < window_height) {
-        color_buffer[window_width * y + x] = color;
+        color_buffer[color_buffer_pitch * y + x] = color;
+    }
+}
+
+clip_rect_t screen_rect(void) {
+    clip_rect_t rect = { 0, 0, window_width, window_height };
+    return rect;
+}
+
+inline void draw_pixel_clipped(int x, int y, uint32_t color, const clip_rect_t* clip) {
+    if (x >= clip->min_x && x < clip->max_x && y >= clip->min_y && y < clip->max_y) {
+        color_buffer[color_buffer_pitch * y + x] = color;
     }
 }
 
 void draw_rect(
     int x, int y, int w, int h, uint32_t color
 ) {
-    for (int r=0;r<h;r++) {
-        for (int c=0; c<w; c++) {
-            int curr_x = x + c;
-            int curr_y = y + r;
-            draw_pixel(curr_x, curr_y, color);
+    clip_rect_t clip = screen_rect();
+    draw_rect_clipped(x, y, w, h, color, &clip);
+}
+
+void draw_rect_clipped(int x, int y, int w, int h, uint32_t color, const clip_rect_t* clip) {
+    // intersect with the clip rectangle once instead of testing every pixel
+    int min_x = x > clip->min_x ? x : clip->min_x;
+    int min_y = y > clip->min_y ? y : clip->min_y;
+    int max_x = x + w < clip->max_x ? x + w : clip->max_x;
+    int max_y = y + h < clip->max_y ? y + h : clip->max_y;
+
+    for (int r=min_y;r<max_y;r++) {
+        for (int c=min_x; c<max_x; c++) {
+            color_buffer[color_buffer_pitch * r + c] = color;
         }
     }
 }
 
 void draw_line(int x0, int y0, int x1, int y1, uint32_t color) {
+    clip_rect_t clip = screen_rect();
+    draw_line_clipped(x0, y0, x1, y1, color, &clip);
+}
+
+// floor and ceil of a / b for b > 0, rounding towards -inf/+inf for negative a as well
+int64_t floor_div(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+int64_t ceil_div(int64_t a, int64_t b) {
+    return a >= 0 ? (a + b - 1) / b : -(-a / b);
+}
+
+// integer line rasterizer shared by the plain and the depth tested lines
+// step i along the major axis lands on minor offset round(i * minor_delta / major_delta),
+// which has a closed form, so the range of steps inside clip is found up front (a Liang-Barsky
+// style clip in step space) and only those steps are walked, Bresenham style, with a pointer
+// the pixels are exactly those of the unclipped line that fall inside clip, whatever clip is
+void rasterize_line(int x0, int y0, int x1, int y1, uint32_t color, const float* inv_w, const clip_rect_t* clip) {
+    // trivial reject when both end points are beyond the same side of clip (Cohen-Sutherland)
+    if ((x0 < clip->min_x && x1 < clip->min_x) || (x0 >= clip->max_x && x1 >= clip->max_x) ||
+        (y0 < clip->min_y && y1 < clip->min_y) || (y0 >= clip->max_y && y1 >= clip->max_y)) {
+        return;
+    }
+
+    // keeps the 64-bit step math below from overflowing
+    if (abs(x0) > LINE_GUARD_BAND || abs(y0) > LINE_GUARD_BAND || abs(x1) > LINE_GUARD_BAND || abs(y1) > LINE_GUARD_BAND) {
+        return;
+    }
+
+    bool x_major = abs(x1 - x0) >= abs(y1 - y0);
+
+    // name everything after the major (a) and minor (b) axes
+    int64_t a0 = x_major ? x0 : y0;
+    int64_t b0 = x_major ? y0 : x0;
+    int64_t delta_a = x_major ? x1 - x0 : y1 - y0;
+    int64_t delta_b = x_major ? y1 - y0 : x1 - x0;
+    int64_t a_min = x_major ? clip->min_x : clip->min_y;
+    int64_t a_max = (x_major ? clip->max_x : clip->max_y) - 1;
+    int64_t b_min = x_major ? clip->min_y : clip->min_x;
+    int64_t b_max = (x_major ? clip->max_y : clip->max_x) - 1;
+
+    int64_t step_a = delta_a >= 0 ? 1 : -1;
+    int64_t step_b = delta_b >= 0 ? 1 : -1;
+    int64_t length = delta_a * step_a;     // number of steps, |delta_a|
+    int64_t rise = delta_b * step_b;       // |delta_b|, never more than length
+
+    // steps for which the major coordinate is inside clip
+    int64_t first = step_a > 0 ? a_min - a0 : a0 - a_max;
+    int64_t last = step_a > 0 ? a_max - a0 : a0 - a_min;
+
+    // minor offsets k (b = b0 + step_b * k) that are inside clip
+    int64_t k_min = step_b > 0 ? b_min - b0 : b0 - b_max;
+    int64_t k_max = step_b > 0 ? b_max - b0 : b0 - b_min;
+
+    if (length == 0) {
+        // a single pixel
+        if (k_min <= 0 && k_max >= 0 && first <= 0 && last >= 0) {
+            first = 0;
+            last = 0;
+        } else {
+            return;
+        }
+    } else if (rise == 0) {
+        if (k_min > 0 || k_max < 0) {
+            return;
+        }
+    } else {
+        // k(i) = floor((2 * i * rise + length) / (2 * length)), solved for i at both ends
+        int64_t first_k = ceil_div(2 * length * k_min - length, 2 * rise);
+        int64_t last_k = floor_div(2 * length * (k_max + 1) - length - 1, 2 * rise);
+        first = first_k > first ? first_k : first;
+        last = last_k < last ? last_k : last;
+    }
+
+    first = first > 0 ? first : 0;
+    last = last < length ? last : length;
+    if (first > last) {
+        return;
+    }
+
+    // Bresenham state at the first visible step
+    int64_t two_length = 2 * length;
+    int64_t numerator = 2 * first * rise + length;
+    int64_t k = length > 0 ? numerator / two_length : 0;
+    int64_t error = length > 0 ? numerator - k * two_length : 0;
+
+    int64_t a = a0 + step_a * first;
+    int64_t b = b0 + step_b * k;
+    int x = x_major ? a : b;
+    int y = x_major ? b : a;
+
+    int stride_a = x_major ? step_a : step_a * color_buffer_pitch;
+    int stride_b = x_major ? step_b * color_buffer_pitch : step_b;
+    uint32_t* pixel = color_buffer + color_buffer_pitch * y + x;
+
+    if (inv_w == NULL) {
+        for (int64_t i = first; i <= last; i++) {
+            *pixel = color;
+            pixel += stride_a;
+            error += 2 * rise;
+            if (error >= two_length) {
+                error -= two_length;
+                pixel += stride_b;
+            }
+        }
+        return;
+    }
+
+    // 1/w is evaluated per step rather than accumulated, so it does not depend on where clipping started
+    // the depth rows are window_width apart, which the color rows may not be
+    int depth_stride_a = x_major ? step_a : step_a * window_width;
+    int depth_stride_b = x_major ? step_b * window_width : step_b;
+    float* depth = z_buffer + window_width * y + x;
+    float inv_w_step = length > 0 ? (inv_w[1] - inv_w[0]) / length : 0;
+    for (int64_t i = first; i <= last; i++) {
+        if ((inv_w[0] + inv_w_step * i) * LINE_DEPTH_BIAS >= *depth) {
+            *pixel = color;
+        }
+        pixel += stride_a;
+        depth += depth_stride_a;
+        error += 2 * rise;
+        if (error >= two_length) {
+            error -= two_length;
+            pixel += stride_b;
+            depth += depth_stride_b;
+        }
+    }
+}
+
+void draw_line_clipped(int x0, int y0, int x1, int y1, uint32_t color, const clip_rect_t* clip) {
+    rasterize_line(x0, y0, x1, y1, color, NULL, clip);
+}
+
+void draw_line_depth_clipped(int x0, int y0, float inv_w0, int x1, int y1, float inv_w1, uint32_t color, const clip_rect_t* clip) {
+    float inv_w[2] = { inv_w0, inv_w1 };
+    rasterize_line(x0, y0, x1, y1, color, inv_w, clip);
+}
+
+// the original floating point DDA, kept as the reference for the line benchmark
+void draw_line_dda_clipped(int x0, int y0, int x1, int y1, uint32_t color, const clip_rect_t* clip) {
+    // skip lines whose bounding box misses the clip rectangle entirely
+    // (one pixel of slack for the rounding drift of the float stepping below)
+    if ((x0 < clip->min_x - 1 && x1 < clip->min_x - 1) || (x0 > clip->max_x && x1 > clip->max_x) ||
+        (y0 < clip->min_y - 1 && y1 < clip->min_y - 1) || (y0 > clip->max_y && y1 > clip->max_y)) {
+        return;
+    }
+
     // basically what DDA algoritm does is
     // find the increments across both axes
     // keep adding those increments to the point
@@ -110,35 +377,133 @@ void draw_line(int x0, int y0, int x1, int y1, uint32_t color) {
     float current_y = y0;
 
     for (int i=0; i<=longest_side_length;i++) {
-        draw_pixel(round(current_x), round(current_y), color);
+        draw_pixel_clipped(round(current_x), round(current_y), color, clip);
         current_x += x_inc;
         current_y += y_inc;
     }
 }
 
 void draw_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color) {
-    draw_line(x0, y0, x1, y1, color);
-    draw_line(x1, y1, x2, y2, color);
-    draw_line(x2, y2, x0, y0, color);
+    clip_rect_t clip = screen_rect();
+    draw_triangle_clipped(x0, y0, x1, y1, x2, y2, color, &clip);
 }
 
-void render_color_buffer(void) {
-    SDL_UpdateTexture(
-        color_buffer_texture,
-        NULL, // render entire texture
-        color_buffer, // the pixel values
-        (int) (window_width * sizeof(uint32_t))
-    );
+void draw_triangle_clipped(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const clip_rect_t* clip) {
+    draw_line_clipped(x0, y0, x1, y1, color, clip);
+    draw_line_clipped(x1, y1, x2, y2, color, clip);
+    draw_line_clipped(x2, y2, x0, y0, color, clip);
+}
+
+void update_color_buffer_texture(int x, int y, int w, int h) {
+    if (is_headless) {
+        for (int row=y; row<y + h; row++) {
+            memcpy(&headless_texture[row * headless_texture_pitch + x], &color_buffer[row * color_buffer_pitch + x], sizeof(uint32_t) * w);
+        }
+    } else {
+        SDL_Rect rect = { x, y, w, h };
+        SDL_UpdateTexture(
+            color_buffer_texture,
+            &rect,
+            &color_buffer[y * color_buffer_pitch + x], // the pixel values
+            (int) (color_buffer_pitch * sizeof(uint32_t))
+        );
+    }
+    profile_count("bytes copied", (double) sizeof(uint32_t) * w * h);
+}
+
+void show_color_buffer_texture(void) {
+    if (is_headless) {
+        return;
+    }
+    // the frame only covers the top left of the texture when it is rendered below the display size
+    SDL_Rect frame = { 0, 0, window_width, window_height };
     SDL_RenderCopy(
         renderer,
         color_buffer_texture,
-        NULL, // render entire texture, no subdivisions
-        NULL // render entire texture, no subdivisions
+        &frame,
+        NULL // stretched over the whole window
     );
+    SDL_RenderPresent(renderer);
+}
+
+void render_color_buffer(void) {
+    update_color_buffer_texture(0, 0, window_width, window_height);
+    show_color_buffer_texture();
+}
+
+bool lock_color_buffer_texture(void) {
+    void* pixels;
+    int pitch;
+    if (is_headless) {
+        pixels = headless_texture;
+        pitch = (int) (headless_texture_pitch * sizeof(uint32_t));
+    } else {
+        SDL_Rect frame = { 0, 0, window_width, window_height };
+        if (SDL_LockTexture(color_buffer_texture, &frame, &pixels, &pitch) != 0) {
+            return false;
+        }
+    }
+    // the pitch is in bytes, rows may be padded but never split a pixel
+    if (pitch % sizeof(uint32_t) != 0 || pitch < (int) (window_width * sizeof(uint32_t))) {
+        if (!is_headless) {
+            SDL_UnlockTexture(color_buffer_texture);
+        }
+        return false;
+    }
+
+    unlocked_color_buffer = color_buffer;
+    color_buffer = (uint32_t*) pixels;
+    color_buffer_pitch = pitch / sizeof(uint32_t);
+    return true;
+}
+
+void render_locked_color_buffer(void) {
+    if (!is_headless) {
+        SDL_UnlockTexture(color_buffer_texture);
+    }
+    show_color_buffer_texture();
+
+    color_buffer = unlocked_color_buffer;
+    color_buffer_pitch = window_width;
 }
 
 void clear_color_buffer(uint32_t color) {
+    for (int y=0; y<window_height; y++) {
+        uint32_t* row = color_buffer + color_buffer_pitch * y;
+        for (int x=0; x<window_width; x++) {
+            row[x] = color;
+        }
+    }
+}
+
+// 0.0f is all zero bits, so the depth clear is a plain memset
+void clear_z_buffer(void) {
+    memset(z_buffer, 0, sizeof(float) * window_width * window_height);
+}
+
+// writes the color buffer as a binary PPM (P6), dropping the alpha channel
+bool save_color_buffer_ppm(const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Error opening %s for writing.\n", filename);
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", window_width, window_height);
+
+    // what was presented last, color_buffer itself misses the frames drawn into a locked texture
+    const uint32_t* pixels = headless_texture ? headless_texture : color_buffer;
+    int pitch = headless_texture ? headless_texture_pitch : color_buffer_pitch;
     for (int i=0;i<window_width*window_height;i++) {
-        color_buffer[i] = color;
+        uint32_t color = pixels[pitch * (i / window_width) + i % window_width];
+        uint8_t rgb[3] = {
+            (color >> 16) & 0xFF,
+            (color >> 8) & 0xFF,
+            color & 0xFF
+        };
+        fwrite(rgb, 1, 3, file);
     }
-}
\ No newline at end of file
+
+    fclose(file);
+    return true;
+}
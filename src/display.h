@@ -8,23 +8,80 @@
 #define FPS 60
 #define FRAME_TARGET_TIME (1000 / FPS)
 
+// half-open pixel rectangle that drawing is restricted to: [min_x, max_x) x [min_y, max_y)
+typedef struct {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+} clip_rect_t;
+
+// size of the frame being rendered: the window's unless set_render_scale shrank it
 extern int window_width;
 extern int window_height;
+// size of the window, the texture and the buffers, frames rendered smaller are stretched over it
+extern int display_width;
+extern int display_height;
 
 extern SDL_Window* window;
 extern SDL_Renderer* renderer;
 
 extern uint32_t* color_buffer;
+// pixels from one row of color_buffer to the next, window_width unless it points into a locked texture
+extern int color_buffer_pitch;
+// per-pixel 1/w of the closest surface so far, 0 means nothing drawn yet
+extern float* z_buffer;
 extern SDL_Texture* color_buffer_texture;
 
+// true when rendering offscreen, without an SDL window/renderer
+extern bool is_headless;
+
 bool initialize_window(void);
+bool initialize_headless(int width, int height);
 void destroy_window(void);
+// renders the following frames at scale times the display size in both directions, scale in (0, 1]
+// color_buffer keeps its memory, the rows just get shorter; returns false if the size didn't change
+bool set_render_scale(float scale);
 void draw_grid(void);
 void draw_pixel(int x, int y, uint32_t color);
 void draw_rect(int x, int y, int w, int h, uint32_t color);
 void draw_line(int x0, int y0, int x1, int y1, uint32_t color);
 void draw_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color);
+
+// floor and ceil of a / b for b > 0, rounding towards -inf/+inf for negative a as well
+int64_t floor_div(int64_t a, int64_t b);
+int64_t ceil_div(int64_t a, int64_t b);
+
+// variants that only touch pixels inside clip, which must lie within the window
+// they produce exactly the pixels of the unclipped versions that fall inside clip
+clip_rect_t screen_rect(void);
+void draw_pixel_clipped(int x, int y, uint32_t color, const clip_rect_t* clip);
+void draw_rect_clipped(int x, int y, int w, int h, uint32_t color, const clip_rect_t* clip);
+void draw_line_clipped(int x0, int y0, int x1, int y1, uint32_t color, const clip_rect_t* clip);
+void draw_triangle_clipped(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const clip_rect_t* clip);
+
+// line that only shows where it is not behind the z_buffer, it does not write depth itself
+void draw_line_depth_clipped(int x0, int y0, float inv_w0, int x1, int y1, float inv_w1, uint32_t color, const clip_rect_t* clip);
+// the previous floating point DDA line, kept for comparison
+void draw_line_dda_clipped(int x0, int y0, int x1, int y1, uint32_t color, const clip_rect_t* clip);
+// the streaming texture color_buffer is presented through, sized to the display; headless it is plain memory
+// with padded rows, so the copy and lock paths run and count the same way without a window
+bool create_color_buffer_texture(void);
+void destroy_color_buffer_texture(void);
+// copies a rectangle of color_buffer into the texture
+void update_color_buffer_texture(int x, int y, int w, int h);
+// stretches the frame in the texture over the window and presents it, nothing headless
+void show_color_buffer_texture(void);
+// uploads the whole frame and shows it
 void render_color_buffer(void);
+// points color_buffer at the pixels of the locked color_buffer_texture, which come back with undefined contents
+// and color_buffer_pitch at its row pitch, false (and nothing changed) if the renderer can't lock it
+bool lock_color_buffer_texture(void);
+// unlocks the texture and shows it, color_buffer points at its own memory again
+void render_locked_color_buffer(void);
 void clear_color_buffer(uint32_t color);
+void clear_z_buffer(void);
+// writes the last presented frame, or color_buffer when nothing presents through a texture
+bool save_color_buffer_ppm(const char* filename);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "dynarray.h"
+#include "allocator.h"
+
+void* dynarray_grow(void* items, size_t* capacity, size_t min_capacity, size_t item_size) {
+    size_t new_capacity = *capacity * 2;
+    if (new_capacity < 16) {
+        new_capacity = 16;
+    }
+    if (new_capacity < min_capacity) {
+        new_capacity = min_capacity;
+    }
+
+    *capacity = new_capacity;
+    return counted_realloc(items, new_capacity * item_size);
+}
+
+void dynarray_release(void* items) {
+    counted_free(items);
+}
@@ -0,0 +1,44 @@
+#ifndef DYNARRAY_H
+#define DYNARRAY_H
+
+#include <stddef.h>
+
+// typed growable array, unlike array.h the length and capacity live in the struct
+// and clearing keeps the capacity, so a buffer refilled every frame stops allocating
+#define DYNARRAY(type)      \
+    struct {                \
+        type* items;        \
+        size_t length;      \
+        size_t capacity;    \
+    }
+
+#define dynarray_reserve(array, count)                                        \
+    do {                                                                      \
+        if ((count) > (array)->capacity) {                                    \
+            (array)->items = dynarray_grow(                                   \
+                (array)->items, &(array)->capacity,                           \
+                (count), sizeof(*(array)->items));                            \
+        }                                                                     \
+    } while (0)
+
+#define dynarray_push(array, value)                                           \
+    do {                                                                      \
+        dynarray_reserve((array), (array)->length + 1);                       \
+        (array)->items[(array)->length++] = (value);                          \
+    } while (0)
+
+#define dynarray_clear(array) ((array)->length = 0)
+
+#define dynarray_free(array)                                                  \
+    do {                                                                      \
+        dynarray_release((array)->items);                                     \
+        (array)->items = NULL;                                                \
+        (array)->length = 0;                                                  \
+        (array)->capacity = 0;                                                \
+    } while (0)
+
+// reallocates items to hold at least min_capacity, at least doubling the capacity
+void* dynarray_grow(void* items, size_t* capacity, size_t min_capacity, size_t item_size);
+void dynarray_release(void* items);
+
+#endif
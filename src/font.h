@@ -0,0 +1,16 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+// 5x7 glyphs with one column of spacing, lowercase is drawn as uppercase
+#define FONT_GLYPH_WIDTH 5
+#define FONT_GLYPH_HEIGHT 7
+#define FONT_ADVANCE 6
+
+// draws text into color_buffer with its top left corner at x, y, every font pixel scale x scale screen pixels
+// anything outside the window is skipped, characters without a glyph are left blank
+void draw_text(int x, int y, const char* text, uint32_t color, int scale);
+int text_width(const char* text, int scale);
+
+#endif
@@ -1,13 +1,29 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#include <math.h>
 #include <SDL2/SDL.h>
+#include "bench.h"
 #include "display.h"
 #include "vector.h"
 #include "mesh.h"
 #include "triangle.h"
 #include "array.h"
 #include "matrix.h"
+#include "transform.h"
+#include "tiles.h"
+#include "rasterizer.h"
+#include "clipping.h"
+#include "allocator.h"
+#include "dynarray.h"
+#include "depth_sort.h"
+#include "scene.h"
+#include "profiler.h"
+#include "pipeline.h"
+#include "background.h"
+#include "texture.h"
 
 enum cull_method {
     CULL_NONE,
@@ -18,40 +34,182 @@ enum render_method {
     RENDER_WIRE,
     RENDER_WIRE_VERTEX,
     RENDER_FILL_TRIANGLE,
-    RENDER_FILL_TRIANGLE_WIRE
+    RENDER_FILL_TRIANGLE_WIRE,
+    RENDER_TEXTURED,
+    RENDER_TEXTURED_WIRE
 } render_method;
 
-triangle_t* triangles_to_render = NULL;
+enum raster_method {
+    RASTER_SINGLE_THREAD,
+    RASTER_TILED
+} raster_method;
+
+enum depth_method {
+    DEPTH_PAINTER_SORT,
+    DEPTH_BUFFER
+} depth_method;
+
+enum fill_method {
+    FILL_HALFSPACE,
+    FILL_SCANLINE
+} fill_method;
+
+enum instance_cull_method {
+    INSTANCE_CULL_NONE,
+    INSTANCE_CULL_BVH
+} instance_cull_method;
+
+enum lod_method {
+    LOD_FULL_DETAIL,
+    LOD_SCREEN_ERROR
+} lod_method;
+
+enum clear_method {
+    // clear, redraw the grid over the whole screen and upload all of it every frame
+    CLEAR_FULL,
+    // restore only the tiles drawn last frame from the cached background, upload only what changed
+    CLEAR_DIRTY
+} clear_method;
+
+enum present_method {
+    // draw into color_buffer and copy it into the streaming texture
+    PRESENT_COPY,
+    // lock the streaming texture and draw straight into its pixels
+    PRESENT_LOCK
+} present_method;
+
+enum resolution_method {
+    // frames are rendered at the display size
+    RESOLUTION_FIXED,
+    // the render scale follows the frame time towards resolution_target_ms
+    RESOLUTION_DYNAMIC
+} resolution_method;
+
+enum frame_method {
+    FRAME_SEQUENTIAL,
+    // the next frame's geometry is built on the pipeline thread while this one is rasterized
+    FRAME_PIPELINED
+} frame_method;
+
+// a little under the frame cap, the present and the wait jitter need some room
+#define RESOLUTION_TARGET_MS (1000.0 / FPS * 0.85)
+// the scale is only touched once the smoothed frame time is off the target by more than this fraction
+#define RESOLUTION_DEAD_BAND 0.08
+// how much of the estimated correction is applied per frame
+#define RESOLUTION_GAIN 0.5
+// weight of the newest frame in the smoothed frame time
+#define RESOLUTION_SMOOTHING 0.25
+// scales are multiples of this, so the size settles instead of creeping by single pixels
+#define RESOLUTION_SCALE_STEP (1.0f / 32)
+
+// the simulation advances in steps of this many milliseconds whatever the frame rate
+#define SIMULATION_STEP_MS (1000.0 / 60)
+// after a stall the simulation skips ahead instead of running every missed step
+#define SIMULATION_MAX_STEPS 8
+
+// how far, in pixels, a simplified level may stray from the full mesh before a finer one is used
+float lod_pixel_error = 1.0;
+
+// threads used by the tiled rasterizer, including the main thread
+int num_raster_threads = 0;
+
+// refilled every frame by update(), keeps its capacity so steady-state frames don't allocate
+triangle_list_t triangles_to_render = { 0 };
+// what render() draws, swapped with triangles_to_render once update() is done with it
+// so the next frame's geometry can be built while this one is rasterized
+triangle_list_t drawn_triangles = { 0 };
+
+// mesh face of every triangle in triangles_to_render, lets the depth sort follow faces across frames
+DYNARRAY(int) triangle_faces = { 0 };
+// the painter's sort gathers into this list and swaps it with triangles_to_render
+triangle_list_t sorted_triangles = { 0 };
+depth_sorter_t depth_sorter = { 0 };
+
+// scratch memory that only lives for one update(), reset at its start
+arena_t frame_arena = { 0 };
+
+// post-transform vertex stream, one entry per mesh vertex of the instance being drawn
+// faces index into it instead of transforming their own corners
+vertex_stream_t vertex_stream;
+
+// shared meshes and the instances drawing them
+scene_t scene = { 0 };
+
+// what the textured render methods put on every mesh
+texture_t mesh_texture = { 0 };
 
 vec3_t camera_position = {
     .x = 0, .y = 0, .z = 0
 };
 
-float fov_factor = 640;
+mat4_t projection_matrix;
+// the camera sits at the origin looking down +z, so the view frustum only depends on the projection
+frustum_t view_frustum;
 
 bool is_running = false;
 // milliseconds
 int previous_frame_time = 0;
 
+// real time not yet simulated, and the counter it was last advanced at
+double simulation_lag_ms = 0;
+uint64_t simulation_clock = 0;
+// how far the frame is between the last two simulation steps
+float simulation_alpha = 1;
+
+// fraction of the display size frames are rendered at, and the bounds the controller keeps it in
+float render_scale = 1;
+float min_render_scale = 0.5;
+float max_render_scale = 1;
+double resolution_target_ms = RESOLUTION_TARGET_MS;
+// smoothed time of the work in a frame, 0 until the first one is measured
+double smoothed_frame_ms = 0;
+// of the last frame, from after the frame cap wait to the end of render()
+double last_frame_ms = 0;
+
 void setup(void) {
     // initialize the render mode and triangle culling method
     render_method = RENDER_WIRE;
     cull_method = CULL_BACKFACE;
+    raster_method = RASTER_SINGLE_THREAD;
+    depth_method = DEPTH_PAINTER_SORT;
+    fill_method = FILL_SCANLINE;
+    instance_cull_method = INSTANCE_CULL_BVH;
+    lod_method = LOD_SCREEN_ERROR;
+    frame_method = FRAME_SEQUENTIAL;
+    clear_method = CLEAR_DIRTY;
+    present_method = PRESENT_COPY;
+    resolution_method = RESOLUTION_FIXED;
+
+    if (num_raster_threads <= 0) {
+        num_raster_threads = SDL_GetCPUCount();
+    }
+    tiles_initialize(num_raster_threads);
 
     color_buffer = (uint32_t*) malloc(
         sizeof(uint32_t) * window_width * window_height
     );
-
-    color_buffer_texture = SDL_CreateTexture(
-        renderer,
-        SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        window_width,
-        window_height
+    z_buffer = (float*) malloc(
+        sizeof(float) * window_width * window_height
     );
+    background_initialize();
+
+    create_color_buffer_texture();
+
+    float fov = M_PI / 3.0; // 60 degrees
+    float aspect = (float) window_height / (float) window_width;
+    float znear = 0.1;
+    float zfar = 100.0;
+    projection_matrix = mat4_make_perspective(fov, aspect, znear, zfar);
+    view_frustum = frustum_from_projection(&projection_matrix);
 
-    load_cube_mesh_data();
-    // load_obj_file_data("./assets/cube.obj");
+    // until a texture is loaded
+    texture_make_checker(&mesh_texture, 256, 32, TEXTURE_TILED);
+
+    // translate the cube away from the camera
+    int cube = scene_add_cube_mesh(&scene);
+    int instance = scene_add_instance(&scene, cube);
+    scene.instances.items[instance].translation.z = 5;
+    // scene_add_obj_mesh(&scene, "./assets/cube.obj");
 }
 
 void process_input(void) {
@@ -83,6 +241,22 @@ void process_input(void) {
                 render_method = RENDER_FILL_TRIANGLE_WIRE;
             }
 
+            if (event.key.keysym.sym == SDLK_5) {
+                render_method = RENDER_TEXTURED;
+            }
+
+            if (event.key.keysym.sym == SDLK_6) {
+                render_method = RENDER_TEXTURED_WIRE;
+            }
+
+            if (event.key.keysym.sym == SDLK_m) {
+                texture_set_layout(&mesh_texture, TEXTURE_TILED);
+            }
+
+            if (event.key.keysym.sym == SDLK_j) {
+                texture_set_layout(&mesh_texture, TEXTURE_LINEAR);
+            }
+
             if (event.key.keysym.sym == SDLK_c) {
                 cull_method = CULL_BACKFACE;
             }
@@ -91,228 +265,1146 @@ void process_input(void) {
                 cull_method = CULL_NONE;
             }
 
+            if (event.key.keysym.sym == SDLK_z) {
+                depth_method = DEPTH_BUFFER;
+            }
+
+            if (event.key.keysym.sym == SDLK_x) {
+                depth_method = DEPTH_PAINTER_SORT;
+            }
+
+            if (event.key.keysym.sym == SDLK_h) {
+                fill_method = FILL_HALFSPACE;
+            }
+
+            if (event.key.keysym.sym == SDLK_s) {
+                fill_method = FILL_SCANLINE;
+            }
+
+            if (event.key.keysym.sym == SDLK_b) {
+                instance_cull_method = INSTANCE_CULL_BVH;
+            }
+
+            if (event.key.keysym.sym == SDLK_n) {
+                instance_cull_method = INSTANCE_CULL_NONE;
+            }
+
+            if (event.key.keysym.sym == SDLK_l) {
+                lod_method = LOD_SCREEN_ERROR;
+            }
+
+            if (event.key.keysym.sym == SDLK_k) {
+                lod_method = LOD_FULL_DETAIL;
+            }
+
+            if (event.key.keysym.sym == SDLK_p) {
+                profiler_enabled = true;
+            }
+
+            if (event.key.keysym.sym == SDLK_o) {
+                profiler_enabled = false;
+            }
+
+            if (event.key.keysym.sym == SDLK_t) {
+                raster_method = RASTER_TILED;
+            }
+
+            if (event.key.keysym.sym == SDLK_y) {
+                raster_method = RASTER_SINGLE_THREAD;
+            }
+
+            if (event.key.keysym.sym == SDLK_r) {
+                clear_method = CLEAR_DIRTY;
+            }
+
+            if (event.key.keysym.sym == SDLK_e) {
+                clear_method = CLEAR_FULL;
+            }
+
+            if (event.key.keysym.sym == SDLK_u) {
+                present_method = PRESENT_LOCK;
+            }
+
+            if (event.key.keysym.sym == SDLK_i) {
+                present_method = PRESENT_COPY;
+            }
+
+            if (event.key.keysym.sym == SDLK_q) {
+                resolution_method = RESOLUTION_DYNAMIC;
+            }
+
+            if (event.key.keysym.sym == SDLK_w) {
+                resolution_method = RESOLUTION_FIXED;
+            }
+
+            if (event.key.keysym.sym == SDLK_g) {
+                frame_method = FRAME_PIPELINED;
+            }
+
+            if (event.key.keysym.sym == SDLK_f) {
+                frame_method = FRAME_SEQUENTIAL;
+            }
+
             break;
     }
 }
 
-// this function projects a 3D vector into a 2D vector
-vec2_t project(vec3_t point) {
-    // perspective projection
-    vec2_t projected_point = {
-        .x = (fov_factor * point.x) / point.z,
-        .y = (fov_factor * point.y) / point.z
+// perspective divide and viewport mapping, same arithmetic as the transform kernels
+vec2_t clip_to_screen(vec4_t v) {
+    float half_width = window_width / 2;
+    float half_height = window_height / 2;
+
+    vec2_t screen_point = {
+        .x = (v.x / v.w) * half_width + half_width,
+        .y = (v.y / v.w) * half_height + half_height
     };
 
-    return projected_point;
+    return screen_point;
 }
 
-// Reference: https://stackoverflow.com/a/27284318/9985287
-// compare function
-int triangle_compare_function (const void * a, const void * b) {
-    triangle_t* t1 = (triangle_t*) a;
-    triangle_t* t2 = (triangle_t*) b;
-    return t2->avg_depth - t1->avg_depth;
-}
+// culls, clips and projects one face whose vertices are in vertex_stream and appends its triangles
+void add_face_triangles(face_t mesh_face, int face_id, uint32_t color, const uint16_t* vertex_outcodes) {
+    int face_indices[3] = { mesh_face.a, mesh_face.b, mesh_face.c };
 
-void update(void) {
-    // wait until the next update time
-    int time_to_wait = FRAME_TARGET_TIME - (SDL_GetTicks() - previous_frame_time);
+    uint16_t outcode_a = vertex_outcodes[face_indices[0]];
+    uint16_t outcode_b = vertex_outcodes[face_indices[1]];
+    uint16_t outcode_c = vertex_outcodes[face_indices[2]];
 
-    if (time_to_wait > 0 && time_to_wait <= FRAME_TARGET_TIME) {
-        SDL_Delay(time_to_wait);
+    // every corner is outside the same frustum plane, nothing of the face can be visible
+    if (outcode_a & outcode_b & outcode_c & OUTSIDE_FRUSTUM) {
+        return;
     }
 
-    previous_frame_time = SDL_GetTicks(); // milliseconds
-
-    triangles_to_render = NULL;
-
-    mesh.rotation.x += 0.01;
-    mesh.rotation.y += 0.01;
-    mesh.rotation.z += 0.01;
-
-    // translate the vertex away from the camera
-    mesh.translation.z = 5;
-
-    // create a scale matrix
-    mat4_t scale_matrix = mat4_make_scale(mesh.scale.x, mesh.scale.y, mesh.scale.z);
-    // create translation matrix
-    mat4_t translation_matrix = mat4_make_translation(mesh.translation.x, mesh.translation.y, mesh.translation.z);
-    // create rotation matrix
-    mat4_t rotation_matrix_x = mat4_make_rotation_x(mesh.rotation.x);
-    mat4_t rotation_matrix_y = mat4_make_rotation_y(mesh.rotation.y);
-    mat4_t rotation_matrix_z = mat4_make_rotation_z(mesh.rotation.z);
-
-    // world matrix
-    mat4_t world_matrix = mat4_identity();
-
-    world_matrix = mat4_mul_mat4(scale_matrix, world_matrix);
-    world_matrix = mat4_mul_mat4(rotation_matrix_x, world_matrix);
-    world_matrix = mat4_mul_mat4(rotation_matrix_y, world_matrix);
-    world_matrix = mat4_mul_mat4(rotation_matrix_z, world_matrix);
-    world_matrix = mat4_mul_mat4(translation_matrix, world_matrix);
-
-    int num_faces = array_length(mesh.faces);
-
-    for (int i=0;i<num_faces;i++) {
-        face_t mesh_face = mesh.faces[i];
-        
-        vec3_t face_vertices[3];
-        face_vertices[0] = mesh.vertices[mesh_face.a - 1];
-        face_vertices[1] = mesh.vertices[mesh_face.b - 1];
-        face_vertices[2] = mesh.vertices[mesh_face.c - 1];
-
-        vec4_t transformed_vertices[3];
-
-        // transformation
-        for (int j=0; j < 3; j++) {
-            vec4_t transformed_vertex = vec4_from_vec3(face_vertices[j]);
-            // multiply the world matrix by the original vector
-            transformed_vertex = mat4_mul_vec4(world_matrix, transformed_vertex);
-            transformed_vertices[j] = transformed_vertex;
-        }
-
-        if (cull_method == CULL_BACKFACE) {
-            // backface culling
+    if (cull_method == CULL_BACKFACE) {
+        bool back_facing;
+        if (!((outcode_a | outcode_b | outcode_c) & OUTSIDE_NEAR)) {
+            // in front of the near plane the projection keeps the winding,
+            // so the sign of the projected area tells which side the camera sees
+            float ax = vertex_stream.screen_x[face_indices[0]];
+            float ay = vertex_stream.screen_y[face_indices[0]];
+            float area = (vertex_stream.screen_x[face_indices[1]] - ax) * (vertex_stream.screen_y[face_indices[2]] - ay) -
+                (vertex_stream.screen_y[face_indices[1]] - ay) * (vertex_stream.screen_x[face_indices[2]] - ax);
+            back_facing = area > 0;
+        } else {
+            // the screen positions of corners behind the camera are meaningless, test in view space instead
             // https://en.wikipedia.org/wiki/Back-face_culling#Implementation
-            vec3_t vector_a = vec3_from_vec4(transformed_vertices[0]);
-            vec3_t vector_b = vec3_from_vec4(transformed_vertices[1]);
-            vec3_t vector_c = vec3_from_vec4(transformed_vertices[2]);
-
-            // culling: find the vectors for the sides of the triangle
-            vec3_t vector_ab = vec3_sub(vector_b, vector_a);
-            vec3_t vector_ac = vec3_sub(vector_c, vector_a);
-            vec3_normalize(&vector_ab);
-            vec3_normalize(&vector_ac);
-
-            // culling: take the cross product of those two vectors to find the normal vector
-            // cross product is not commutative!
+            // the sign of the dot product doesn't depend on the lengths, so nothing is normalized
+            vec3_t vector_a = { vertex_stream.x[face_indices[0]], vertex_stream.y[face_indices[0]], vertex_stream.z[face_indices[0]] };
+            vec3_t vector_b = { vertex_stream.x[face_indices[1]], vertex_stream.y[face_indices[1]], vertex_stream.z[face_indices[1]] };
+            vec3_t vector_c = { vertex_stream.x[face_indices[2]], vertex_stream.y[face_indices[2]], vertex_stream.z[face_indices[2]] };
+
             // we're using a left handed coordinate system
             // it's clockwise, thus the following order
-            vec3_t normal = vec3_cross(vector_ab, vector_ac);
-            // normalize the face normal vector
-            vec3_normalize(&normal);
-
-            // culling: find the vector between a point in the triangle and the camera origin
+            vec3_t normal = vec3_cross(vec3_sub(vector_b, vector_a), vec3_sub(vector_c, vector_a));
             vec3_t camera_ray = vec3_sub(camera_position, vector_a);
-
-            // culling: find the dot product to find if the triangle is looking towards the camera
-            // dot product is commutative
-            float dot_normal_camera = vec3_dot(camera_ray, normal);
-
-            // bypass the triangles that are not looking at the camera
-            if (dot_normal_camera < 0) {
-                continue;
-            }
+            back_facing = vec3_dot(camera_ray, normal) < 0;
         }
 
-        vec2_t projected_points[3];
-
-        // perform projection
-        for (int j=0; j < 3; j++) {
-
-            // project the current vertex
-            projected_points[j] = project(vec3_from_vec4(transformed_vertices[j]));
-
-            // scale and translate the projected point to the middle of the screen
-            projected_points[j].x += (window_width / 2);
-            projected_points[j].y += (window_height / 2);
+        // bypass the triangles that are not looking at the camera
+        if (back_facing) {
+            return;
         }
+    }
 
-        // calculate the average depth for each face based on the vertices after transformation
-        float avg_depth = (transformed_vertices[0].z + transformed_vertices[1].z + transformed_vertices[2].z)/3.0; 
+    // calculate the average depth for each face based on the vertices after transformation
+    float avg_depth = (
+        vertex_stream.z[face_indices[0]] +
+        vertex_stream.z[face_indices[1]] +
+        vertex_stream.z[face_indices[2]]
+    ) / 3.0;
 
+    // common case: inside the near and far planes and the guard band, use the projected corners as they are
+    if (!((outcode_a | outcode_b | outcode_c) & OUTSIDE_CLIP_PLANES)) {
         triangle_t projected_triangle = {
             .points = {
-                { projected_points[0].x, projected_points[0].y },
-                { projected_points[1].x, projected_points[1].y },
-                { projected_points[2].x, projected_points[2].y }
+                { vertex_stream.screen_x[face_indices[0]], vertex_stream.screen_y[face_indices[0]] },
+                { vertex_stream.screen_x[face_indices[1]], vertex_stream.screen_y[face_indices[1]] },
+                { vertex_stream.screen_x[face_indices[2]], vertex_stream.screen_y[face_indices[2]] }
+            },
+            .inv_w = {
+                1.0 / vertex_stream.clip_w[face_indices[0]],
+                1.0 / vertex_stream.clip_w[face_indices[1]],
+                1.0 / vertex_stream.clip_w[face_indices[2]]
             },
-            .color = mesh_face.color,
+            .texcoords = { mesh_face.a_uv, mesh_face.b_uv, mesh_face.c_uv },
+            .color = color,
             .avg_depth = avg_depth
         };
 
         // save for rendering
-        array_push(triangles_to_render, projected_triangle);
+        dynarray_push(&triangles_to_render, projected_triangle);
+        dynarray_push(&triangle_faces, face_id);
+        return;
     }
 
-    // sort the triangles to render by their average depth
-    qsort(
-        triangles_to_render, 
-        array_length(triangles_to_render), 
-        sizeof(triangle_t), 
-        triangle_compare_function
-    );
+    vec4_t clip_vertices[3];
+    for (int j=0; j<3; j++) {
+        clip_vertices[j].x = vertex_stream.clip_x[face_indices[j]];
+        clip_vertices[j].y = vertex_stream.clip_y[face_indices[j]];
+        clip_vertices[j].z = vertex_stream.clip_z[face_indices[j]];
+        clip_vertices[j].w = vertex_stream.clip_w[face_indices[j]];
+    }
+
+    polygon_t polygon = polygon_from_triangle(clip_vertices[0], clip_vertices[1], clip_vertices[2], mesh_face.a_uv, mesh_face.b_uv, mesh_face.c_uv);
+    clip_polygon(&polygon, outcode_a | outcode_b | outcode_c);
+
+    // the clipped polygon is convex, so a fan around its first vertex covers it
+    for (int j=1; j+1<polygon.num_vertices; j++) {
+        vec4_t fan[3] = { polygon.vertices[0], polygon.vertices[j], polygon.vertices[j + 1] };
+
+        triangle_t projected_triangle = {
+            .points = { clip_to_screen(fan[0]), clip_to_screen(fan[1]), clip_to_screen(fan[2]) },
+            .inv_w = { 1.0 / fan[0].w, 1.0 / fan[1].w, 1.0 / fan[2].w },
+            .texcoords = { polygon.texcoords[0], polygon.texcoords[j], polygon.texcoords[j + 1] },
+            .color = color,
+            .avg_depth = avg_depth
+        };
+
+        dynarray_push(&triangles_to_render, projected_triangle);
+        dynarray_push(&triangle_faces, face_id);
+    }
 }
 
-void render(void) {
-    draw_grid();
-
-    int num_triangles = array_length(triangles_to_render);
-    
-    for (int i=0; i<num_triangles; i++) {
-        triangle_t triangle = triangles_to_render[i];
-
-        if (
-            render_method == RENDER_FILL_TRIANGLE || 
-            render_method == RENDER_FILL_TRIANGLE_WIRE
-        ) {
-            draw_filled_triangle(
-                triangle.points[0].x, triangle.points[0].y,
-                triangle.points[1].x, triangle.points[1].y,
-                triangle.points[2].x, triangle.points[2].y,
-                triangle.color
+// appends the triangles of one instance whose vertices are in vertex_stream,
+// meshlets facing away from the camera are skipped without looking at their faces
+// scale is the instance's uniform scale, cones are only usable when there is one
+// face_offset makes the face ids unique over the scene
+void add_instance_triangles(const face_t* faces, const meshlet_t* meshlets, const mat4_t* world, float scale, bool use_cones, uint32_t color, int face_offset, const uint16_t* vertex_outcodes) {
+    int num_faces = array_length((void*) faces);
+    int num_meshlets = meshlets ? array_length((void*) meshlets) : 0;
+    use_cones = use_cones && cull_method == CULL_BACKFACE;
+
+    for (int m=0; m<num_meshlets || (m == 0 && !meshlets); m++) {
+        int first_face = meshlets ? meshlets[m].first_face : 0;
+        int last_face = meshlets ? first_face + meshlets[m].num_faces : num_faces;
+
+        if (meshlets && use_cones) {
+            // the camera is the view space origin, so world space is all the cone test needs
+            const meshlet_t* meshlet = &meshlets[m];
+            vec3_t center = vec3_from_vec4(mat4_mul_vec4(*world, vec4_from_vec3(meshlet->sphere.center)));
+            vec3_t axis = vec3_from_vec4(mat4_mul_vec4(*world, (vec4_t){ meshlet->cone_axis.x, meshlet->cone_axis.y, meshlet->cone_axis.z, 0 }));
+            axis = vec3_div(axis, scale);
+            if (meshlet_backfacing(center, meshlet->sphere.radius * scale, axis, meshlet->cone_cos)) {
+                continue;
+            }
+        }
+
+        for (int i=first_face; i<last_face; i++) {
+            uint32_t face_color = color == INSTANCE_MESH_COLOR ? faces[i].color : color;
+            add_face_triangles(faces[i], face_offset + i, face_color, vertex_outcodes);
+        }
+    }
+}
+
+void step_simulation(void) {
+    for (size_t k=0; k<scene.instances.length; k++) {
+        instance_t* instance = &scene.instances.items[k];
+        instance->previous_rotation = instance->rotation;
+        instance->rotation.x += 0.01;
+        instance->rotation.y += 0.01;
+        instance->rotation.z += 0.01;
+    }
+}
+
+// runs the simulation steps the real time since the last frame is worth
+// headless runs are measured frame by frame, so they take exactly one step per frame
+void advance_simulation(void) {
+    if (is_headless) {
+        step_simulation();
+        simulation_alpha = 1;
+        return;
+    }
+
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (simulation_clock != 0) {
+        simulation_lag_ms += (double) (now - simulation_clock) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+    }
+    simulation_clock = now;
+
+    if (simulation_lag_ms > SIMULATION_STEP_MS * SIMULATION_MAX_STEPS) {
+        simulation_lag_ms = SIMULATION_STEP_MS * SIMULATION_MAX_STEPS;
+    }
+    while (simulation_lag_ms >= SIMULATION_STEP_MS) {
+        step_simulation();
+        simulation_lag_ms -= SIMULATION_STEP_MS;
+    }
+    simulation_alpha = (float) (simulation_lag_ms / SIMULATION_STEP_MS);
+}
+
+// sleeps off what is left of the frame cap
+void wait_for_frame_time(void) {
+    int time_to_wait = FRAME_TARGET_TIME - (SDL_GetTicks() - previous_frame_time);
+
+    if (time_to_wait > 0 && time_to_wait <= FRAME_TARGET_TIME) {
+        uint64_t wait_start = profile_begin();
+        SDL_Delay(time_to_wait);
+        profile_end("wait", wait_start);
+    }
+
+    previous_frame_time = SDL_GetTicks(); // milliseconds
+}
+
+// builds triangles_to_render from the scene, touches nothing render() reads
+void update(void) {
+    uint64_t update_start = profile_begin();
+    arena_reset(&frame_arena);
+    dynarray_clear(&triangles_to_render);
+    dynarray_clear(&triangle_faces);
+
+    uint64_t scene_start = profile_begin();
+    scene_update_world_matrices(&scene, simulation_alpha);
+    // whole instances outside the frustum are dropped before any of their vertices are touched
+    scene_cull(&scene, instance_cull_method == INSTANCE_CULL_BVH ? &view_frustum : NULL);
+    if (lod_method == LOD_SCREEN_ERROR) {
+        // a unit at distance 1 spans the y scale of the projection times half the viewport height
+        scene_select_lods(&scene, projection_matrix.m[1][1] * window_height / 2, lod_pixel_error);
+    }
+    profile_end("scene", scene_start);
+
+    // clipping can split a face, but most frames fit in one triangle per face,
+    // the headroom covers instances turning visible from one frame to the next
+    size_t num_visible_faces = (size_t) scene.num_visible_faces;
+    size_t num_triangles_reserved = num_visible_faces > triangles_to_render.capacity ? num_visible_faces + num_visible_faces / 2 : num_visible_faces;
+    dynarray_reserve(&triangles_to_render, num_triangles_reserved);
+    dynarray_reserve(&triangle_faces, num_triangles_reserved);
+    dynarray_reserve(&sorted_triangles, num_triangles_reserved);
+
+    // every instance reuses the same vertex stream and outcodes, only the triangles accumulate
+    uint16_t* vertex_outcodes = (uint16_t*) arena_alloc(&frame_arena, sizeof(uint16_t) * scene.max_vertices);
+
+    uint64_t instances_start = profile_begin();
+    for (size_t v=0; v<scene.visible_instances.length; v++) {
+        int k = scene.visible_instances.items[v];
+        const instance_t* instance = &scene.instances.items[k];
+        const mesh_t* mesh = &scene.meshes.items[instance->mesh];
+        int level = scene.visible_lods.items[v];
+        const vertex_soa_t* positions = mesh_level_positions(mesh, level);
+
+        // transform and project every unique vertex exactly once, several per simd step
+        vertex_stream_reserve(&vertex_stream, positions->padded_count);
+        transform_vertices(
+            &scene.world_matrices.items[k],
+            &projection_matrix,
+            positions,
+            &vertex_stream,
+            window_width / 2,
+            window_height / 2
+        );
+
+        // frustum and guard band outcodes, parallel to vertex_stream
+        for (int i=0; i<positions->count; i++) {
+            vertex_outcodes[i] = clip_outcode(vertex_stream.clip_x[i], vertex_stream.clip_y[i], vertex_stream.clip_z[i], vertex_stream.clip_w[i]);
+        }
+
+        // cones only stay cones under uniform scaling
+        float scale = instance->scale.x;
+        bool uniform_scale = scale > 0 && instance->scale.y == scale && instance->scale.z == scale;
+
+        add_instance_triangles(
+            mesh_level_faces(mesh, level),
+            mesh_level_meshlets(mesh, level),
+            &scene.world_matrices.items[k],
+            scale,
+            uniform_scale,
+            instance->color,
+            scene.face_offsets.items[k],
+            vertex_outcodes
+        );
+    }
+    profile_end("instances", instances_start);
+
+    // the depth buffer resolves visibility per pixel, so only the painter's algorithm needs the sort
+    if (depth_method == DEPTH_PAINTER_SORT) {
+        uint64_t sort_start = profile_begin();
+        // sort the triangles to render by their average depth, far to near
+        // the instances only rotate a little per frame, so last frame's order is nearly right already
+        size_t num_triangles = triangles_to_render.length;
+        const depth_key_t* order = depth_sorter_sort(
+            &depth_sorter,
+            triangles_to_render.items,
+            triangle_faces.items,
+            num_triangles,
+            scene.num_faces,
+            true
+        );
+
+        dynarray_reserve(&sorted_triangles, num_triangles);
+        for (size_t k=0; k<num_triangles; k++) {
+            sorted_triangles.items[k] = triangles_to_render.items[order[k].index];
+        }
+        sorted_triangles.length = num_triangles;
+
+        triangle_list_t swap = triangles_to_render;
+        triangles_to_render = sorted_triangles;
+        sorted_triangles = swap;
+        profile_end("sort", sort_start);
+    }
+    profile_end("update", update_start);
+}
+
+// draws one triangle in the current render method, only inside clip
+void draw_triangle_to_render(const triangle_t* triangle, const clip_rect_t* clip) {
+    bool depth_test = depth_method == DEPTH_BUFFER;
+    bool textured = render_method == RENDER_TEXTURED || render_method == RENDER_TEXTURED_WIRE;
+    bool wire = render_method == RENDER_WIRE || render_method == RENDER_WIRE_VERTEX ||
+        render_method == RENDER_FILL_TRIANGLE_WIRE || render_method == RENDER_TEXTURED_WIRE;
+
+    if (
+        render_method == RENDER_FILL_TRIANGLE || 
+        render_method == RENDER_FILL_TRIANGLE_WIRE ||
+        // a triangle outside the textured filler's guard band is filled flat
+        (textured && !draw_textured_triangle(triangle, &mesh_texture, depth_test, clip))
+    ) {
+        // the half-space filler declines triangles outside its guard band
+        bool filled = fill_method == FILL_HALFSPACE && draw_filled_triangle_halfspace(triangle, depth_test, clip);
+
+        if (!filled && depth_test) {
+            draw_filled_triangle_depth_clipped(triangle, clip);
+        } else if (!filled) {
+            draw_filled_triangle_clipped(
+                triangle->points[0].x, triangle->points[0].y,
+                triangle->points[1].x, triangle->points[1].y,
+                triangle->points[2].x, triangle->points[2].y,
+                triangle->color,
+                clip
             );
         }
+    }
 
-        if (
-            render_method == RENDER_WIRE || 
-            render_method == RENDER_WIRE_VERTEX || 
-            render_method == RENDER_FILL_TRIANGLE_WIRE
-        ) {
-            draw_triangle(
-                triangle.points[0].x, triangle.points[0].y,
-                triangle.points[1].x, triangle.points[1].y,
-                triangle.points[2].x, triangle.points[2].y,
-                0xFFFFFFFF
+    if (wire && depth_test) {
+        for (int j=0; j<3; j++) {
+            int k = (j + 1) % 3;
+            draw_line_depth_clipped(
+                triangle->points[j].x, triangle->points[j].y, triangle->inv_w[j],
+                triangle->points[k].x, triangle->points[k].y, triangle->inv_w[k],
+                0xFFFFFFFF,
+                clip
             );
         }
+    } else if (wire) {
+        draw_triangle_clipped(
+            triangle->points[0].x, triangle->points[0].y,
+            triangle->points[1].x, triangle->points[1].y,
+            triangle->points[2].x, triangle->points[2].y,
+            0xFFFFFFFF,
+            clip
+        );
+    }
+
+    if (render_method == RENDER_WIRE_VERTEX) {
+        draw_rect_clipped(triangle->points[0].x - 3, triangle->points[0].y - 3, 6, 6, 0xFFFF0000, clip);
+        draw_rect_clipped(triangle->points[1].x - 3, triangle->points[1].y - 3, 6, 6, 0xFFFF0000, clip);
+        draw_rect_clipped(triangle->points[2].x - 3, triangle->points[2].y - 3, 6, 6, 0xFFFF0000, clip);
+    }
+}
+
+void render(void) {
+    uint64_t render_start = profile_begin();
+
+    int num_triangles = (int) drawn_triangles.length;
+
+    // a renderer that can't lock the texture keeps copying into it from then on
+    bool locked = false;
+    if (present_method == PRESENT_LOCK) {
+        locked = lock_color_buffer_texture();
+        if (!locked) {
+            fprintf(stderr, "Locking the streaming texture failed, copying frames into it instead.\n");
+            present_method = PRESENT_COPY;
+        }
+    }
 
-        if (render_method == RENDER_WIRE_VERTEX) {
-            draw_rect(triangle.points[0].x - 3, triangle.points[0].y - 3, 6, 6, 0xFFFF0000);
-            draw_rect(triangle.points[1].x - 3, triangle.points[1].y - 3, 6, 6, 0xFFFF0000);
-            draw_rect(triangle.points[2].x - 3, triangle.points[2].y - 3, 6, 6, 0xFFFF0000);
+    // clear first, so the color buffer still holds the finished frame after render()
+    // the dirty tiles are tracked either way, so switching to CLEAR_DIRTY knows what the last frame drew
+    uint64_t clear_start = profile_begin();
+    dirty_begin_frame();
+    dirty_mark_triangles(drawn_triangles.items, num_triangles);
+    if (clear_method == CLEAR_DIRTY) {
+        // nothing of the last frame is left in a locked texture
+        if (locked) {
+            background_restore_all();
+        } else {
+            background_restore();
+        }
+        if (depth_method == DEPTH_BUFFER) {
+            dirty_clear_z_buffer();
         }
+        profile_end("clear", clear_start);
+    } else {
+        clear_color_buffer(0xFF000000);
+        if (depth_method == DEPTH_BUFFER) {
+            clear_z_buffer();
+        }
+        profile_end("clear", clear_start);
+
+        uint64_t grid_start = profile_begin();
+        draw_grid();
+        profile_end("grid", grid_start);
     }
 
-    array_free(triangles_to_render);
+    uint64_t raster_start = profile_begin();
+
+    if (raster_method == RASTER_TILED) {
+        tiles_render(drawn_triangles.items, num_triangles, draw_triangle_to_render);
+    } else {
+        clip_rect_t clip = screen_rect();
+        for (int i=0; i<num_triangles; i++) {
+            draw_triangle_to_render(&drawn_triangles.items[i], &clip);
+        }
+    }
+    profile_end("raster", raster_start);
+
+    // the overlay shows last frame's numbers, this frame's are only complete after present
+    if (profiler_enabled) {
+        uint64_t hud_start = profile_begin();
+        profiler_draw_overlay();
+        profile_end("hud", hud_start);
+    }
+
+    if (locked) {
+        // color_buffer's own memory missed this frame, so all of it is restored and uploaded the next time it is used
+        dirty_mark_all();
+    }
+
+    // headless, the frame still goes through the texture stand-in, only the showing is skipped
+    uint64_t present_start = profile_begin();
+    if (locked) {
+        render_locked_color_buffer();
+    } else if (clear_method == CLEAR_DIRTY) {
+        render_dirty_color_buffer();
+    } else {
+        render_color_buffer();
+    }
+    profile_end("present", present_start);
+    profile_end("render", render_start);
+}
+
+// renders the next frames at scale times the display size, true when the size changed
+bool apply_render_scale(float scale) {
+    render_scale = scale;
+    if (!set_render_scale(scale)) {
+        return false;
+    }
+    dirty_resize();
+    return true;
+}
+
+// feedback on the frame time: raster cost goes with the pixel count, the square of the scale,
+// so the scale moves by part of the square root of how far the smoothed time is off the target
+// returns true when the render size changed
+bool update_render_scale(double frame_ms) {
+    smoothed_frame_ms = smoothed_frame_ms == 0 ? frame_ms : smoothed_frame_ms + (frame_ms - smoothed_frame_ms) * RESOLUTION_SMOOTHING;
+    double ratio = resolution_target_ms / smoothed_frame_ms;
+    if (fabs(ratio - 1) < RESOLUTION_DEAD_BAND) {
+        return false;
+    }
+
+    float scale = render_scale * (float) pow(ratio, 0.5 * RESOLUTION_GAIN);
+    scale = roundf(scale / RESOLUTION_SCALE_STEP) * RESOLUTION_SCALE_STEP;
+    // past the dead band it moves at least a step, small scales would round back to where they are
+    if (scale == render_scale) {
+        scale += ratio > 1 ? RESOLUTION_SCALE_STEP : -RESOLUTION_SCALE_STEP;
+    }
+    scale = fminf(fmaxf(scale, min_render_scale), max_render_scale);
+    if (scale == render_scale) {
+        return false;
+    }
+    return apply_render_scale(scale);
+}
+
+// hands the triangles update() built to render(), and render()'s last list back to update() to refill
+void swap_triangle_lists(void) {
+    triangle_list_t swap = triangles_to_render;
+    triangles_to_render = drawn_triangles;
+    drawn_triangles = swap;
+    // the list handed back keeps up with the other one, so refilling it doesn't grow it mid-frame
+    dynarray_reserve(&triangles_to_render, drawn_triangles.capacity);
+}
+
+// one iteration of the main loop, also what the benchmark times
+// pipelined, the frame draws the geometry the previous frame started building and starts the next one,
+// so the picture is a frame behind the simulation; the pipeline thread is idle while the input,
+// the simulation and the swap change what it reads
+void run_frame(void) {
+    uint64_t frame_start = profile_begin();
+    if (!is_headless) {
+        wait_for_frame_time();
+    }
+    uint64_t work_start = SDL_GetPerformanceCounter();
+    pipeline_wait_job();
+
+    if (!is_headless) {
+        uint64_t input_start = profile_begin();
+        process_input();
+        profile_end("input", input_start);
+    }
+    advance_simulation();
+
+    // the size only changes while the pipeline thread is idle, the projection reads it
+    bool resized = false;
+    if (resolution_method == RESOLUTION_DYNAMIC && last_frame_ms > 0) {
+        resized = update_render_scale(last_frame_ms);
+    } else if (resolution_method == RESOLUTION_FIXED && render_scale != 1) {
+        smoothed_frame_ms = 0;
+        resized = apply_render_scale(1);
+    }
 
-    render_color_buffer();
+    // triangles built at the old size can't be drawn at the new one, so a resize builds them here
+    if (frame_method == FRAME_SEQUENTIAL || resized) {
+        update();
+    }
+    swap_triangle_lists();
+    if (frame_method == FRAME_PIPELINED) {
+        pipeline_start_job(update);
+    }
+    render();
+    last_frame_ms = (double) (SDL_GetPerformanceCounter() - work_start) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+    profile_end("frame", frame_start);
 
-    clear_color_buffer(0xFF000000);
+    if (profiler_enabled) {
+        profiler_end_frame();
+    }
+}
 
-    SDL_RenderPresent(renderer);
+// lets the pipeline finish and drops the triangles built so far, before the scene changes under them
+void drain_frames(void) {
+    pipeline_wait_job();
+    dynarray_clear(&triangles_to_render);
+    dynarray_clear(&drawn_triangles);
 }
 
 void free_resources(void) {
+    pipeline_shutdown();
+    background_free();
     // free the buffer in the memory
     free(color_buffer);
-    array_free(mesh.vertices);
-    array_free(mesh.faces);
+    free(z_buffer);
+    vertex_stream_free(&vertex_stream);
+    dynarray_free(&triangles_to_render);
+    dynarray_free(&drawn_triangles);
+    dynarray_free(&sorted_triangles);
+    dynarray_free(&triangle_faces);
+    depth_sorter_free(&depth_sorter);
+    arena_free(&frame_arena);
+    scene_free(&scene);
+    texture_free(&mesh_texture);
+    destroy_color_buffer_texture();
+    tiles_shutdown();
+}
+
+// the assets are modelled at very different sizes, they are scaled to a unit radius
+// to keep them in front of the camera at the fixed z=5
+float unit_radius_scale(const mesh_t* mesh) {
+    float radius = 0;
+    for (int i=0; i<array_length(mesh->vertices); i++) {
+        float length = vec3_length(mesh->vertices[i]);
+        radius = length > radius ? length : radius;
+    }
+    return radius > 0 ? 1.0 / radius : 1.0;
 }
 
-int main(void) {
+// renders every bundled asset offscreen for a fixed number of frames
+// and reports how long each frame took
+void run_benchmark(int num_frames, int num_instances, bool field, bool verbose) {
+    char* assets[] = { "cube", "f22", "teapot" };
+    int num_assets = sizeof(assets) / sizeof(assets[0]);
+    uint32_t instance_colors[] = { 0xFFE0E0E0, 0xFFFF8080, 0xFF80FF80, 0xFF8080FF, 0xFFFFFF80, 0xFF80FFFF };
+    int num_instance_colors = sizeof(instance_colors) / sizeof(instance_colors[0]);
+
+    double* frame_ms = (double*) malloc(sizeof(double) * num_frames);
+
+    printf("headless benchmark: %dx%d, %d frames, %d instances%s, render method %d, %s frames, %s raster, %s, %s fill, %s\n",
+        window_width, window_height, num_frames, num_instances, field ? " in a field" : "", render_method,
+        frame_method == FRAME_PIPELINED ? "pipelined" : "sequential",
+        raster_method == RASTER_TILED ? "tiled" : "single-thread",
+        depth_method == DEPTH_BUFFER ? "depth buffer" : "painter's sort",
+        fill_method == FILL_HALFSPACE ? "half-space" : "scanline",
+        instance_cull_method == INSTANCE_CULL_BVH ? "bvh culling" : "no instance culling");
+    if (lod_method == LOD_SCREEN_ERROR) {
+        printf("levels of detail up to %.2f pixels of error\n", lod_pixel_error);
+    }
+    bench_print_header();
+
+    for (int a=0; a<num_assets; a++) {
+        char path[256];
+        snprintf(path, sizeof(path), "./assets/%s.obj", assets[a]);
+
+        // the asset is loaded once, every instance draws the same vertices and faces
+        drain_frames();
+        scene_free(&scene);
+        int asset = scene_add_obj_mesh(&scene, path);
+        const mesh_t* mesh = &scene.meshes.items[asset];
+        if (array_length(mesh->faces) == 0) {
+            fprintf(stderr, "Skipping %s, no faces loaded.\n", path);
+            continue;
+        }
+
+        float scale = unit_radius_scale(mesh);
+
+        if (field) {
+            // a square field around the camera, most of it behind or beside the view
+            int side = (int) ceil(sqrt(num_instances));
+            float spacing = 3;
+            for (int k=0; k<num_instances; k++) {
+                int index = scene_add_instance(&scene, asset);
+                instance_t* instance = &scene.instances.items[index];
+                instance->scale = (vec3_t){ scale, scale, scale };
+                instance->translation = (vec3_t){
+                    ((k % side) - (side - 1) / 2.0) * spacing,
+                    -1.5,
+                    ((k / side) - (side - 1) / 2.0) * spacing
+                };
+                instance->rotation = (vec3_t){ k * 0.37, k * 0.23, k * 0.11 };
+                instance->color = instance_colors[k % num_instance_colors];
+            }
+        } else {
+            // more instances go on a grid facing the camera, pushed back far enough to fit the view
+            int columns = (int) ceil(sqrt(num_instances));
+            int rows = (num_instances + columns - 1) / columns;
+            float spacing = 2.5;
+            float distance = fmaxf(5, fmaxf(rows * 2.2, columns * 1.3));
+
+            for (int k=0; k<num_instances; k++) {
+                int index = scene_add_instance(&scene, asset);
+                instance_t* instance = &scene.instances.items[index];
+                instance->scale = (vec3_t){ scale, scale, scale };
+                instance->translation = (vec3_t){
+                    ((k % columns) - (columns - 1) / 2.0) * spacing,
+                    ((k / columns) - (rows - 1) / 2.0) * spacing,
+                    distance
+                };
+                if (k > 0) {
+                    instance->rotation = (vec3_t){ k * 0.37, k * 0.23, k * 0.11 };
+                    instance->color = instance_colors[k % num_instance_colors];
+                }
+            }
+        }
+
+        long long total_triangles = 0;
+        int steady_allocations = 0;
+        // pipelined, the first frame's geometry is only waited for in the second
+        int warmup_frames = frame_method == FRAME_PIPELINED ? 2 : 1;
+
+        for (int i=0; i<num_frames; i++) {
+            int allocations = allocation_count();
+            double start = bench_now_ms();
+            run_frame();
+            total_triangles += drawn_triangles.length;
+            frame_ms[i] = bench_now_ms() - start;
+
+            // the first frame of an asset grows the buffers, every later one should reuse them
+            if (i >= warmup_frames) {
+                steady_allocations += allocation_count() - allocations;
+            }
+
+            if (verbose) {
+                printf("%s frame %d: %.3f ms\n", assets[a], i, frame_ms[i]);
+            }
+        }
+
+        bench_stats_t stats = bench_compute_stats(frame_ms, num_frames, total_triangles);
+        stats.allocations_per_frame = num_frames > warmup_frames ? steady_allocations / (double) (num_frames - warmup_frames) : 0;
+        bench_print_stats(assets[a], stats);
+        if (resolution_method == RESOLUTION_DYNAMIC) {
+            printf("  render scale %.3f (%dx%d), smoothed frame %.3f ms for a %.3f ms target\n",
+                render_scale, window_width, window_height, smoothed_frame_ms, resolution_target_ms);
+        }
+        if (profiler_enabled) {
+            profiler_print_summary();
+            profiler_reset_stages();
+        }
+
+        char image_path[256];
+        snprintf(image_path, sizeof(image_path), "bench_%s.ppm", assets[a]);
+        save_color_buffer_ppm(image_path);
+    }
+
+    free(frame_ms);
+}
+
+// fixed scenes under every render and cull method, each case starts from the same rotation and turns
+// by the same steps, so two runs with the same flags draw the same frames; the results go to output as csv
+bool run_benchmark_suite(int num_frames, const char* output) {
+    char* scenes[] = { "cube", "f22", "teapot", "grid1m" };
+    int num_scenes = sizeof(scenes) / sizeof(scenes[0]);
+    char* render_names[] = { "wire", "wire_vertex", "fill", "fill_wire", "textured", "textured_wire" };
+    char* cull_names[] = { "none", "backface" };
+    int num_render_methods = sizeof(render_names) / sizeof(render_names[0]);
+    int num_cull_methods = sizeof(cull_names) / sizeof(cull_names[0]);
+
+    int num_results = 0;
+    bench_result_t* results = (bench_result_t*) malloc(sizeof(bench_result_t) * num_scenes * num_render_methods * num_cull_methods);
+    double* frame_ms = (double*) malloc(sizeof(double) * num_frames);
+
+    // levels of detail would make the drawn triangles depend on their tuning, the suite measures the full meshes
+    lod_method = LOD_FULL_DETAIL;
+
+    printf("benchmark suite: %dx%d, %d frames per case, %s frames, %s raster, %s, %s fill, %s clear, %s present\n",
+        window_width, window_height, num_frames,
+        frame_method == FRAME_PIPELINED ? "pipelined" : "sequential",
+        raster_method == RASTER_TILED ? "tiled" : "single-thread",
+        depth_method == DEPTH_BUFFER ? "depth buffer" : "painter's sort",
+        fill_method == FILL_HALFSPACE ? "half-space" : "scanline",
+        clear_method == CLEAR_DIRTY ? "dirty tile" : "full",
+        present_method == PRESENT_LOCK ? "locked texture" : "copy");
+    bench_print_header();
+
+    for (int s=0; s<num_scenes; s++) {
+        drain_frames();
+        scene_free(&scene);
+        int mesh_index;
+        if (strcmp(scenes[s], "grid1m") == 0) {
+            // 708 x 708 cells of two triangles, just over a million
+            mesh_index = scene_add_grid_mesh(&scene, 708, 708);
+        } else {
+            char path[256];
+            snprintf(path, sizeof(path), "./assets/%s.obj", scenes[s]);
+            mesh_index = scene_add_obj_mesh(&scene, path);
+        }
+        const mesh_t* mesh = &scene.meshes.items[mesh_index];
+        if (array_length(mesh->faces) == 0) {
+            fprintf(stderr, "Skipping %s, no faces loaded.\n", scenes[s]);
+            continue;
+        }
+
+        float scale = unit_radius_scale(mesh);
+        int instance_index = scene_add_instance(&scene, mesh_index);
+        instance_t* instance = &scene.instances.items[instance_index];
+        instance->scale = (vec3_t){ scale, scale, scale };
+        instance->translation.z = 5;
+
+        for (int r=0; r<num_render_methods; r++) {
+            for (int c=0; c<num_cull_methods; c++) {
+                // the pipeline thread reads the cull method
+                drain_frames();
+                render_method = r;
+                cull_method = c;
+                instance->rotation = (vec3_t){ 0, 0, 0 };
+
+                bool peak_reset = bench_reset_peak_rss();
+                long peak_before = peak_reset ? 0 : bench_peak_rss_kb();
+
+                // the warm-up frames of run_benchmark aren't timed: they grow the buffers, and pipelined
+                // the first frame only starts the geometry the second one draws
+                int warmup_frames = frame_method == FRAME_PIPELINED ? 2 : 1;
+                for (int i=0; i<warmup_frames; i++) {
+                    run_frame();
+                }
+
+                long long total_triangles = 0;
+                for (int i=0; i<num_frames; i++) {
+                    double start = bench_now_ms();
+                    run_frame();
+                    total_triangles += drawn_triangles.length;
+                    frame_ms[i] = bench_now_ms() - start;
+                }
+
+                bench_result_t* result = &results[num_results++];
+                snprintf(result->name, sizeof(result->name), "%s_%s_%s", scenes[s], render_names[r], cull_names[c]);
+                result->width = window_width;
+                result->height = window_height;
+                result->stats = bench_compute_stats(frame_ms, num_frames, total_triangles);
+                result->pixels_per_sec = result->stats.total_ms > 0 ?
+                    (double) window_width * window_height * num_frames / (result->stats.total_ms / 1000.0) : 0;
+                result->peak_rss_kb = bench_peak_rss_kb() - peak_before;
+                bench_print_stats(result->name, result->stats);
+            }
+        }
+    }
+
+    bool written = bench_write_results(output, results, num_results);
+    if (written) {
+        printf("%d cases written to %s\n", num_results, output);
+    }
+
+    free(frame_ms);
+    free(results);
+    return written;
+}
+
+// replaces the checker setup() made with the file when there is one, a file that can't be read keeps the checker
+void load_mesh_texture(const char* filename, bool linear_texels) {
+    texture_layout_t layout = linear_texels ? TEXTURE_LINEAR : TEXTURE_TILED;
+    texture_set_layout(&mesh_texture, layout);
+    if (filename) {
+        texture_load_ppm(&mesh_texture, filename, layout);
+    }
+}
+
+// the method flags of the command line, the window, the benchmark and the suite all start from them
+typedef struct {
+    int mode;               // a render_method, or -1 for setup()'s
+    bool tiled;
+    bool pipelined;
+    bool full_clear;
+    bool lock_texture;
+    bool dynamic_resolution;
+    bool depth_buffer;
+    bool halfspace_fill;
+    bool no_bvh;
+    bool no_lod;
+} render_options_t;
+
+// overrides what setup() picked, call right after it
+void apply_render_options(const render_options_t* options) {
+    if (options->mode >= RENDER_WIRE && options->mode <= RENDER_TEXTURED_WIRE) {
+        render_method = options->mode;
+    }
+    if (options->tiled) {
+        raster_method = RASTER_TILED;
+    }
+    if (options->pipelined) {
+        frame_method = FRAME_PIPELINED;
+    }
+    if (options->full_clear) {
+        clear_method = CLEAR_FULL;
+    }
+    if (options->lock_texture) {
+        present_method = PRESENT_LOCK;
+    }
+    if (options->dynamic_resolution) {
+        resolution_method = RESOLUTION_DYNAMIC;
+    }
+    if (options->depth_buffer) {
+        depth_method = DEPTH_BUFFER;
+    }
+    if (options->halfspace_fill) {
+        fill_method = FILL_HALFSPACE;
+    }
+    if (options->no_bvh) {
+        instance_cull_method = INSTANCE_CULL_NONE;
+    }
+    if (options->no_lod) {
+        lod_method = LOD_FULL_DETAIL;
+    }
+}
+
+void print_usage(char* program) {
+    printf("usage: %s [--bench | --bench-suite [--out FILE] | --bench-compare BASELINE CURRENT [--threshold PERCENT] | --bench-transform | --bench-math | --bench-fill | --bench-lines | --bench-load | --bench-optimize | --bench-sort | --bench-texture] [--frames N] [--instances N] [--field] [--no-bvh] [--no-lod] [--lod-error PIXELS] [--size WIDTHxHEIGHT] [--mode 0-5] [--texture FILE.ppm] [--linear-texels] [--tiled] [--pipelined] [--full-clear] [--lock-texture] [--dynamic-resolution] [--scale-min S] [--scale-max S] [--target-ms MS] [--threads N] [--depth] [--halfspace] [--profile] [--trace FILE] [--verbose]\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    bool benchmark = false;
+    bool benchmark_transform = false;
+    bool verbose = false;
+    render_options_t options = { .mode = -1 };
+    bool benchmark_fill = false;
+    bool benchmark_lines = false;
+    bool benchmark_load = false;
+    bool benchmark_sort = false;
+    bool benchmark_optimize = false;
+    bool benchmark_math = false;
+    bool benchmark_texture = false;
+    bool benchmark_suite = false;
+    char* suite_output = "bench_results.csv";
+    char* compare_baseline = NULL;
+    char* compare_current = NULL;
+    double compare_threshold = 5;
+    // 0 until --frames, the benchmark and the suite have their own defaults
+    int num_frames = 0;
+    int num_instances = 1;
+    bool field = false;
+    int width = 1920;
+    int height = 1080;
+    char* texture_filename = NULL;
+    bool linear_texels = false;
+    char* trace_filename = NULL;
+
+    for (int i=1; i<argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            benchmark = true;
+        } else if (strcmp(argv[i], "--bench-suite") == 0) {
+            benchmark_suite = true;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            suite_output = argv[++i];
+        } else if (strcmp(argv[i], "--bench-compare") == 0 && i + 2 < argc) {
+            compare_baseline = argv[++i];
+            compare_current = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            compare_threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-transform") == 0) {
+            benchmark_transform = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            num_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+            num_instances = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--field") == 0) {
+            field = true;
+        } else if (strcmp(argv[i], "--no-bvh") == 0) {
+            options.no_bvh = true;
+        } else if (strcmp(argv[i], "--no-lod") == 0) {
+            options.no_lod = true;
+        } else if (strcmp(argv[i], "--lod-error") == 0 && i + 1 < argc) {
+            lod_pixel_error = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &width, &height);
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            options.mode = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--texture") == 0 && i + 1 < argc) {
+            texture_filename = argv[++i];
+        } else if (strcmp(argv[i], "--linear-texels") == 0) {
+            linear_texels = true;
+        } else if (strcmp(argv[i], "--tiled") == 0) {
+            options.tiled = true;
+        } else if (strcmp(argv[i], "--pipelined") == 0) {
+            options.pipelined = true;
+        } else if (strcmp(argv[i], "--full-clear") == 0) {
+            options.full_clear = true;
+        } else if (strcmp(argv[i], "--lock-texture") == 0) {
+            options.lock_texture = true;
+        } else if (strcmp(argv[i], "--dynamic-resolution") == 0) {
+            options.dynamic_resolution = true;
+        } else if (strcmp(argv[i], "--scale-min") == 0 && i + 1 < argc) {
+            min_render_scale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--scale-max") == 0 && i + 1 < argc) {
+            max_render_scale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc) {
+            resolution_target_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-fill") == 0) {
+            benchmark_fill = true;
+        } else if (strcmp(argv[i], "--bench-lines") == 0) {
+            benchmark_lines = true;
+        } else if (strcmp(argv[i], "--bench-sort") == 0) {
+            benchmark_sort = true;
+        } else if (strcmp(argv[i], "--bench-math") == 0) {
+            benchmark_math = true;
+        } else if (strcmp(argv[i], "--bench-texture") == 0) {
+            benchmark_texture = true;
+        } else if (strcmp(argv[i], "--bench-optimize") == 0) {
+            benchmark_optimize = true;
+        } else if (strcmp(argv[i], "--bench-load") == 0) {
+            benchmark_load = true;
+        } else if (strcmp(argv[i], "--halfspace") == 0) {
+            options.halfspace_fill = true;
+        } else if (strcmp(argv[i], "--depth") == 0) {
+            options.depth_buffer = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_raster_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profiler_enabled = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_filename = argv[++i];
+            profiler_enabled = true;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (compare_baseline) {
+        int regressions = bench_compare_results(compare_baseline, compare_current, compare_threshold / 100.0);
+        return regressions == 0 ? 0 : 1;
+    }
+
+    // the render size never exceeds the display size
+    max_render_scale = fminf(fmaxf(max_render_scale, RESOLUTION_SCALE_STEP), 1);
+    min_render_scale = fminf(fmaxf(min_render_scale, RESOLUTION_SCALE_STEP), max_render_scale);
+
+    if (benchmark_transform) {
+        bench_vertex_transform(1 << 20, 50);
+        return 0;
+    }
+
+    if (benchmark_math) {
+        bench_math_kernels(20000);
+        return 0;
+    }
+
+    if (benchmark_fill) {
+        if (!initialize_headless(width, height)) {
+            return 1;
+        }
+        bench_fill_rate(200000);
+        return 0;
+    }
+
+    if (benchmark_texture) {
+        if (!initialize_headless(width, height)) {
+            return 1;
+        }
+        bench_texture_sampling(2048, 20);
+        return 0;
+    }
+
+    if (benchmark_lines) {
+        if (!initialize_headless(width, height)) {
+            return 1;
+        }
+        bench_line_rate(100000);
+        return 0;
+    }
+
+    if (benchmark_load) {
+        char* assets[] = { "./assets/cube.obj", "./assets/f22.obj", "./assets/teapot.obj" };
+        bench_obj_load(assets, sizeof(assets) / sizeof(assets[0]), 1 << 19);
+        return 0;
+    }
+
+    if (benchmark_optimize) {
+        char* assets[] = { "./assets/cube.obj", "./assets/f22.obj", "./assets/teapot.obj" };
+        bench_mesh_optimize(assets, sizeof(assets) / sizeof(assets[0]), 1 << 20, 50);
+        return 0;
+    }
+
+    if (benchmark_sort) {
+        bench_depth_sort("./assets/teapot.obj", 1 << 20, 30);
+        return 0;
+    }
+
+    if (benchmark_suite) {
+        if (num_frames <= 0) {
+            num_frames = 60;
+        }
+        if (!initialize_headless(width, height)) {
+            return 1;
+        }
+
+        setup();
+        load_mesh_texture(texture_filename, linear_texels);
+        apply_render_options(&options);
+
+        bool written = run_benchmark_suite(num_frames, suite_output);
+        free_resources();
+        return written ? 0 : 1;
+    }
+
+    if (benchmark) {
+        if (num_frames == 0) {
+            num_frames = 300;
+        }
+        if (num_frames <= 0 || num_instances <= 0 || !initialize_headless(width, height)) {
+            return 1;
+        }
+
+        setup();
+        load_mesh_texture(texture_filename, linear_texels);
+        apply_render_options(&options);
+
+        run_benchmark(num_frames, num_instances, field, verbose);
+        if (trace_filename) {
+            profiler_write_trace(trace_filename);
+        }
+
+        free_resources();
+        return 0;
+    }
+
 
     // Create an SDL window
     is_running = initialize_window();
 
     setup();
+    load_mesh_texture(texture_filename, linear_texels);
+    apply_render_options(&options);
 
     while(is_running) {
-        process_input();
-        update();
-        render();
+        run_frame();
     }
 
+    if (trace_filename) {
+        profiler_write_trace(trace_filename);
+    }
     destroy_window();
     free_resources();
 
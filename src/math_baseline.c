@@ -1,17 +1,34 @@
-#include "matrix.h"
 #include <math.h>
+#include "math_baseline.h"
 
-mat4_t mat4_identity(void) {
-    mat4_t m = {{
-        {1, 0, 0, 0},
-        {0, 1, 0, 0},
-        {0, 0, 1, 0},
-        {0, 0, 0, 1}
-    }};
-    return m;
+vec3_t baseline_vec3_cross(vec3_t a, vec3_t b) {
+    vec3_t r = {
+        .x = a.y*b.z - a.z*b.y,
+        .y = a.z*b.x - a.x*b.z,
+        .z = a.x*b.y - a.y*b.x
+    };
+
+    return r;
+}
+
+void baseline_vec3_normalize(vec3_t* v) {
+    float length = sqrt(v->x * v->x + v->y * v->y + v->z * v->z);
+    v->x = v->x / length;
+    v->y = v->y / length;
+    v->z = v->z / length;
 }
 
-mat4_t mat4_make_scale(float sx, float sy, float sz) {
+vec3_t baseline_vec3_rotate_y(vec3_t v, float angle) {
+    vec3_t rotated_vector = {
+        .x = v.x * cos(angle) - v.z * sin(angle),
+        .y = v.y,
+        .z = v.x * sin(angle) + v.z * cos(angle)
+    };
+
+    return rotated_vector;
+}
+
+mat4_t baseline_mat4_make_scale(float sx, float sy, float sz) {
     mat4_t id = mat4_identity();
     id.m[0][0] = sx;
     id.m[1][1] = sy;
@@ -20,18 +37,7 @@ mat4_t mat4_make_scale(float sx, float sy, float sz) {
     return id;
 }
 
-vec4_t mat4_mul_vec4(mat4_t m, vec4_t v) {
-    vec4_t result;
-
-    result.x = m.m[0][0] * v.x + m.m[0][1] * v.y + m.m[0][2] * v.z + m.m[0][3] * v.w;
-    result.y = m.m[1][0] * v.x + m.m[1][1] * v.y + m.m[1][2] * v.z + m.m[1][3] * v.w;
-    result.z = m.m[2][0] * v.x + m.m[2][1] * v.y + m.m[2][2] * v.z + m.m[2][3] * v.w;
-    result.w = m.m[3][0] * v.x + m.m[3][1] * v.y + m.m[3][2] * v.z + m.m[3][3] * v.w;
-
-    return result;
-}
-
-mat4_t mat4_make_translation(float tx, float ty, float tz) {
+mat4_t baseline_mat4_make_translation(float tx, float ty, float tz) {
     mat4_t id = mat4_identity();
     id.m[0][3] = tx;
     id.m[1][3] = ty;
@@ -40,7 +46,7 @@ mat4_t mat4_make_translation(float tx, float ty, float tz) {
     return id;
 }
 
-mat4_t mat4_make_rotation_x(float angle) {
+mat4_t baseline_mat4_make_rotation_x(float angle) {
     float c = cos(angle);
     float s = sin(angle);
 
@@ -53,7 +59,8 @@ mat4_t mat4_make_rotation_x(float angle) {
 
     return m;
 }
-mat4_t mat4_make_rotation_y(float angle) {
+
+mat4_t baseline_mat4_make_rotation_y(float angle) {
     float c = cos(angle);
     float s = sin(angle);
 
@@ -67,7 +74,7 @@ mat4_t mat4_make_rotation_y(float angle) {
     return m;
 }
 
-mat4_t mat4_make_rotation_z(float angle) {
+mat4_t baseline_mat4_make_rotation_z(float angle) {
     float c = cos(angle);
     float s = sin(angle);
 
@@ -81,11 +88,22 @@ mat4_t mat4_make_rotation_z(float angle) {
     return m;
 }
 
-mat4_t mat4_mul_mat4(mat4_t a, mat4_t b) {
+vec4_t baseline_mat4_mul_vec4(mat4_t m, vec4_t v) {
+    vec4_t result;
+
+    result.x = m.m[0][0] * v.x + m.m[0][1] * v.y + m.m[0][2] * v.z + m.m[0][3] * v.w;
+    result.y = m.m[1][0] * v.x + m.m[1][1] * v.y + m.m[1][2] * v.z + m.m[1][3] * v.w;
+    result.z = m.m[2][0] * v.x + m.m[2][1] * v.y + m.m[2][2] * v.z + m.m[2][3] * v.w;
+    result.w = m.m[3][0] * v.x + m.m[3][1] * v.y + m.m[3][2] * v.z + m.m[3][3] * v.w;
+
+    return result;
+}
+
+mat4_t baseline_mat4_mul_mat4(mat4_t a, mat4_t b) {
     mat4_t m;
     for (int i=0;i<4;i++) {
         for (int j=0;j<4;j++) {
-            m.m[i][j] = 
+            m.m[i][j] =
                 a.m[i][0] * b.m[0][j] +
                 a.m[i][1] * b.m[1][j] +
                 a.m[i][2] * b.m[2][j] +
@@ -93,4 +111,4 @@ mat4_t mat4_mul_mat4(mat4_t a, mat4_t b) {
         }
     }
     return m;
-}
\ No newline at end of file
+}
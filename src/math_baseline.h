@@ -0,0 +1,20 @@
+#ifndef MATH_BASELINE_H
+#define MATH_BASELINE_H
+
+#include "vector.h"
+#include "matrix.h"
+
+// the out-of-line, by-value math vector.h and matrix.h used to be, with double trig,
+// only kept as the baseline for the math benchmark, in its own file so it can't be inlined
+vec3_t baseline_vec3_cross(vec3_t a, vec3_t b);
+void baseline_vec3_normalize(vec3_t* v);
+vec3_t baseline_vec3_rotate_y(vec3_t v, float angle);
+mat4_t baseline_mat4_make_scale(float sx, float sy, float sz);
+mat4_t baseline_mat4_make_translation(float tx, float ty, float tz);
+mat4_t baseline_mat4_make_rotation_x(float angle);
+mat4_t baseline_mat4_make_rotation_y(float angle);
+mat4_t baseline_mat4_make_rotation_z(float angle);
+vec4_t baseline_mat4_mul_vec4(mat4_t m, vec4_t v);
+mat4_t baseline_mat4_mul_mat4(mat4_t a, mat4_t b);
+
+#endif
@@ -1,19 +1,160 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include <math.h>
 #include "vector.h"
 
-typedef struct {
+// header-only like vector.h, the builders use float trig
+
+typedef struct MATH_ALIGN(16) {
     float m[4][4];
 } mat4_t;
 
-mat4_t mat4_identity(void);
-mat4_t mat4_make_scale(float sx, float sy, float sz);
-mat4_t mat4_make_translation(float tx, float ty, float tz);
-mat4_t mat4_make_rotation_x(float angle);
-mat4_t mat4_make_rotation_y(float angle);
-mat4_t mat4_make_rotation_z(float angle);
-vec4_t mat4_mul_vec4(mat4_t m, vec4_t v);
-mat4_t mat4_mul_mat4(mat4_t a, mat4_t b);
+static inline mat4_t mat4_identity(void) {
+    mat4_t m = {{
+        {1, 0, 0, 0},
+        {0, 1, 0, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1}
+    }};
+    return m;
+}
+
+static inline mat4_t mat4_make_scale(float sx, float sy, float sz) {
+    mat4_t id = mat4_identity();
+    id.m[0][0] = sx;
+    id.m[1][1] = sy;
+    id.m[2][2] = sz;
+
+    return id;
+}
+
+static inline mat4_t mat4_make_translation(float tx, float ty, float tz) {
+    mat4_t id = mat4_identity();
+    id.m[0][3] = tx;
+    id.m[1][3] = ty;
+    id.m[2][3] = tz;
+
+    return id;
+}
+
+static inline mat4_t mat4_make_rotation_x(float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+
+    mat4_t m = mat4_identity();
+
+    m.m[1][1] = c;
+    m.m[1][2] = -s;
+    m.m[2][1] = s;
+    m.m[2][2] = c;
+
+    return m;
+}
+
+static inline mat4_t mat4_make_rotation_y(float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+
+    mat4_t m = mat4_identity();
+
+    m.m[0][0] = c;
+    m.m[0][2] = s;
+    m.m[2][0] = -s;
+    m.m[2][2] = c;
+
+    return m;
+}
+
+static inline mat4_t mat4_make_rotation_z(float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+
+    mat4_t m = mat4_identity();
+
+    m.m[0][0] = c;
+    m.m[0][1] = -s;
+    m.m[1][0] = s;
+    m.m[1][1] = c;
+
+    return m;
+}
+
+// translation * rotation_z * rotation_y * rotation_x * scale written out in one go,
+// three sinf/cosf pairs and no matrix products
+static inline mat4_t mat4_make_world(vec3_t scale, vec3_t rotation, vec3_t translation) {
+    float cx = cosf(rotation.x), sx = sinf(rotation.x);
+    float cy = cosf(rotation.y), sy = sinf(rotation.y);
+    float cz = cosf(rotation.z), sz = sinf(rotation.z);
+
+    mat4_t m = {{
+        { cz * cy * scale.x, (cz * sy * sx - sz * cx) * scale.y, (cz * sy * cx + sz * sx) * scale.z, translation.x },
+        { sz * cy * scale.x, (sz * sy * sx + cz * cx) * scale.y, (sz * sy * cx - cz * sx) * scale.z, translation.y },
+        { -sy * scale.x,     cy * sx * scale.y,                  cy * cx * scale.z,                  translation.z },
+        { 0,                 0,                                  0,                                  1 }
+    }};
+    return m;
+}
+
+// left handed, maps z in [znear, zfar] to [0, w] and puts the view space z into w
+static inline mat4_t mat4_make_perspective(float fov, float aspect, float znear, float zfar) {
+    // aspect is height / width, so x is scaled down on wide screens
+    float f = 1.0f / tanf(fov / 2);
+
+    mat4_t m = {{{ 0 }}};
+
+    m.m[0][0] = aspect * f;
+    m.m[1][1] = f;
+    m.m[2][2] = zfar / (zfar - znear);
+    m.m[2][3] = (-zfar * znear) / (zfar - znear);
+    m.m[3][2] = 1.0f;
+
+    return m;
+}
+
+static inline vec4_t mat4_mul_vec4(mat4_t m, vec4_t v) {
+    vec4_t result;
+
+    result.x = m.m[0][0] * v.x + m.m[0][1] * v.y + m.m[0][2] * v.z + m.m[0][3] * v.w;
+    result.y = m.m[1][0] * v.x + m.m[1][1] * v.y + m.m[1][2] * v.z + m.m[1][3] * v.w;
+    result.z = m.m[2][0] * v.x + m.m[2][1] * v.y + m.m[2][2] * v.z + m.m[2][3] * v.w;
+    result.w = m.m[3][0] * v.x + m.m[3][1] * v.y + m.m[3][2] * v.z + m.m[3][3] * v.w;
+
+    return result;
+}
+
+static inline mat4_t mat4_mul_mat4(mat4_t a, mat4_t b) {
+    mat4_t m;
+    for (int i=0; i<4; i++) {
+        for (int j=0; j<4; j++) {
+            m.m[i][j] =
+                a.m[i][0] * b.m[0][j] +
+                a.m[i][1] * b.m[1][j] +
+                a.m[i][2] * b.m[2][j] +
+                a.m[i][3] * b.m[3][j];
+        }
+    }
+    return m;
+}
+
+// pointer variants for callers that keep matrices in arrays, out must not alias the inputs
+static inline void mat4_mul_vec4_into(vec4_t* restrict out, const mat4_t* restrict m, const vec4_t* restrict v) {
+    out->x = m->m[0][0] * v->x + m->m[0][1] * v->y + m->m[0][2] * v->z + m->m[0][3] * v->w;
+    out->y = m->m[1][0] * v->x + m->m[1][1] * v->y + m->m[1][2] * v->z + m->m[1][3] * v->w;
+    out->z = m->m[2][0] * v->x + m->m[2][1] * v->y + m->m[2][2] * v->z + m->m[2][3] * v->w;
+    out->w = m->m[3][0] * v->x + m->m[3][1] * v->y + m->m[3][2] * v->z + m->m[3][3] * v->w;
+}
+
+static inline void mat4_mul_mat4_into(mat4_t* restrict out, const mat4_t* restrict a, const mat4_t* restrict b) {
+    for (int i=0; i<4; i++) {
+        for (int j=0; j<4; j++) {
+            out->m[i][j] =
+                a->m[i][0] * b->m[0][j] +
+                a->m[i][1] * b->m[1][j] +
+                a->m[i][2] * b->m[2][j] +
+                a->m[i][3] * b->m[3][j];
+        }
+    }
+}
 
-#endif
\ No newline at end of file
+#endif
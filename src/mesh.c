@@ -1,63 +1,189 @@
 #include <stdio.h>
 #include "mesh.h"
 #include "array.h"
+#include "obj.h"
+#include "simplify.h"
+#include "mesh_optimize.h"
 #include <string.h>
-
-mesh_t mesh = {
-    .vertices = NULL,
-    .faces = NULL,
-    .rotation = {0, 0, 0},
-    .scale = {1.0, 1.0, 1.0},
-    .translation = {0, 0, 0}
-};
+#include <math.h>
 
 vec3_t cube_vertices[N_CUBE_VERTICES] = {
-    { .x = -1, .y = -1, .z = -1 }, // 1
-    { .x = -1, .y =  1, .z = -1 }, // 2
-    { .x =  1, .y =  1, .z = -1 }, // 3
-    { .x =  1, .y = -1, .z = -1 }, // 4
-    { .x =  1, .y =  1, .z =  1 }, // 5
-    { .x =  1, .y = -1, .z =  1 }, // 6
-    { .x = -1, .y =  1, .z =  1 }, // 7
-    { .x = -1, .y = -1, .z =  1 }, // 8
+    { .x = -1, .y = -1, .z = -1 }, // 0
+    { .x = -1, .y =  1, .z = -1 }, // 1
+    { .x =  1, .y =  1, .z = -1 }, // 2
+    { .x =  1, .y = -1, .z = -1 }, // 3
+    { .x =  1, .y =  1, .z =  1 }, // 4
+    { .x =  1, .y = -1, .z =  1 }, // 5
+    { .x = -1, .y =  1, .z =  1 }, // 6
+    { .x = -1, .y = -1, .z =  1 }, // 7
 };
 
 face_t cube_faces[N_CUBE_FACES] = {
     // front
-    { .a = 1, .b = 2, .c = 3, .color = 0xFFFF0000},
-    { .a = 1, .b = 3, .c = 4, .color = 0xFFFF0000},
+    { .a = 0, .b = 1, .c = 2, .a_uv = { 0, 1 }, .b_uv = { 0, 0 }, .c_uv = { 1, 0 }, .color = 0xFFFF0000 },
+    { .a = 0, .b = 2, .c = 3, .a_uv = { 0, 1 }, .b_uv = { 1, 0 }, .c_uv = { 1, 1 }, .color = 0xFFFF0000 },
     // right
-    { .a = 4, .b = 3, .c = 5, .color = 0xFF00FF00},
-    { .a = 4, .b = 5, .c = 6, .color = 0xFF00FF00},
+    { .a = 3, .b = 2, .c = 4, .a_uv = { 0, 1 }, .b_uv = { 0, 0 }, .c_uv = { 1, 0 }, .color = 0xFF00FF00 },
+    { .a = 3, .b = 4, .c = 5, .a_uv = { 0, 1 }, .b_uv = { 1, 0 }, .c_uv = { 1, 1 }, .color = 0xFF00FF00 },
     // back
-    { .a = 6, .b = 5, .c = 7, .color = 0xFF0000FF},
-    { .a = 6, .b = 7, .c = 8, .color = 0xFF0000FF},
+    { .a = 5, .b = 4, .c = 6, .a_uv = { 0, 1 }, .b_uv = { 0, 0 }, .c_uv = { 1, 0 }, .color = 0xFF0000FF },
+    { .a = 5, .b = 6, .c = 7, .a_uv = { 0, 1 }, .b_uv = { 1, 0 }, .c_uv = { 1, 1 }, .color = 0xFF0000FF },
     // left
-    { .a = 8, .b = 7, .c = 2, .color = 0xFFFFFF00},
-    { .a = 8, .b = 2, .c = 1, .color = 0xFFFFFF00},
+    { .a = 7, .b = 6, .c = 1, .a_uv = { 0, 1 }, .b_uv = { 0, 0 }, .c_uv = { 1, 0 }, .color = 0xFFFFFF00 },
+    { .a = 7, .b = 1, .c = 0, .a_uv = { 0, 1 }, .b_uv = { 1, 0 }, .c_uv = { 1, 1 }, .color = 0xFFFFFF00 },
     // top
-    { .a = 2, .b = 7, .c = 5, .color = 0xFFFF00FF},
-    { .a = 2, .b = 5, .c = 3, .color = 0xFFFF00FF},
+    { .a = 1, .b = 6, .c = 4, .a_uv = { 0, 1 }, .b_uv = { 0, 0 }, .c_uv = { 1, 0 }, .color = 0xFFFF00FF },
+    { .a = 1, .b = 4, .c = 2, .a_uv = { 0, 1 }, .b_uv = { 1, 0 }, .c_uv = { 1, 1 }, .color = 0xFFFF00FF },
     // bottom
-    { .a = 6, .b = 8, .c = 1, .color = 0xFF00FFFF},
-    { .a = 6, .b = 1, .c = 4, .color = 0xFF00FFFF}
+    { .a = 5, .b = 7, .c = 0, .a_uv = { 0, 1 }, .b_uv = { 0, 0 }, .c_uv = { 1, 0 }, .color = 0xFF00FFFF },
+    { .a = 5, .b = 0, .c = 3, .a_uv = { 0, 1 }, .b_uv = { 1, 0 }, .c_uv = { 1, 1 }, .color = 0xFF00FFFF }
 };
 
-void load_cube_mesh_data(void) {
+// the scene culls whole instances with these before transforming any vertex
+void compute_mesh_bounds(mesh_t* mesh) {
+    int num_vertices = array_length(mesh->vertices);
+    mesh->bounds = aabb_from_points(mesh->vertices, num_vertices);
+    mesh->sphere = bounding_sphere_from_points(mesh->vertices, num_vertices, mesh->bounds);
+}
+
+void load_cube_mesh_data(mesh_t* mesh) {
     for (int i=0; i < N_CUBE_VERTICES; i++) {
-        array_push(mesh.vertices, cube_vertices[i]);
+        array_push(mesh->vertices, cube_vertices[i]);
     }
 
     for (int i=0; i < N_CUBE_FACES; i++) {
-        array_push(mesh.faces, cube_faces[i]);
+        array_push(mesh->faces, cube_faces[i]);
+    }
+    optimize_mesh(&mesh->vertices, &mesh->faces, NULL);
+
+    vertex_soa_build(&mesh->positions, mesh->vertices, array_length(mesh->vertices));
+    compute_mesh_bounds(mesh);
+}
+
+void free_mesh_lods(mesh_t* mesh) {
+    for (int i=0; i<mesh->num_lods; i++) {
+        // levels loaded from the cache point into its mapping
+        if (!mesh->cache.base) {
+            array_free(mesh->lods[i].vertices);
+            array_free(mesh->lods[i].faces);
+            array_free(mesh->lods[i].meshlets);
+        }
+        vertex_soa_free(&mesh->lods[i].positions);
+    }
+    memset(mesh->lods, 0, sizeof(mesh->lods));
+    mesh->num_lods = 0;
+}
+
+// frees the vertex and face arrays, or unmaps the cache file they point into
+// along with the levels and meshlets built from them
+void release_mesh_geometry(mesh_t* mesh) {
+    free_mesh_lods(mesh);
+
+    if (mesh->cache.base) {
+        mesh_cache_release(&mesh->cache);
+    } else {
+        array_free(mesh->vertices);
+        array_free(mesh->faces);
+        array_free(mesh->meshlets);
+    }
+    mesh->vertices = NULL;
+    mesh->faces = NULL;
+    mesh->meshlets = NULL;
+}
+
+void load_obj_file_data(mesh_t* mesh, char* filename) {
+    // replaces whatever geometry the mesh had, the indices would not line up otherwise
+    release_mesh_geometry(mesh);
+
+    // <filename>.cache holds the parsed arrays, it is rebuilt whenever the .obj changes
+    char cache_filename[1024];
+    snprintf(cache_filename, sizeof(cache_filename), "%s%s", filename, MESH_CACHE_EXTENSION);
+
+    mesh_cache_level_t levels[MESH_CACHE_MAX_LEVELS];
+    int num_levels = 0;
+    if (mesh_cache_load(cache_filename, filename, &mesh->cache, levels, &num_levels)) {
+        mesh->vertices = levels[0].vertices;
+        mesh->faces = levels[0].faces;
+        mesh->meshlets = levels[0].meshlets;
+        mesh->num_lods = num_levels - 1;
+        for (int i=0; i<mesh->num_lods; i++) {
+            mesh->lods[i].vertices = levels[i + 1].vertices;
+            mesh->lods[i].faces = levels[i + 1].faces;
+            mesh->lods[i].meshlets = levels[i + 1].meshlets;
+            mesh->lods[i].error = levels[i + 1].error;
+            vertex_soa_build(&mesh->lods[i].positions, mesh->lods[i].vertices, array_length(mesh->lods[i].vertices));
+        }
+    } else if (obj_load(filename, &mesh->vertices, &mesh->faces)) {
+        // the cache holds the optimized arrays, the simplified levels and the meshlets with the faces already
+        // reordered for them, so this only runs when the .obj changes
+        optimize_mesh(&mesh->vertices, &mesh->faces, NULL);
+        build_mesh_lods(mesh);
+        build_mesh_meshlets(mesh);
+
+        levels[0] = (mesh_cache_level_t){ mesh->vertices, mesh->faces, mesh->meshlets, 0 };
+        for (int i=0; i<mesh->num_lods; i++) {
+            const mesh_lod_t* lod = &mesh->lods[i];
+            levels[i + 1] = (mesh_cache_level_t){ lod->vertices, lod->faces, lod->meshlets, lod->error };
+        }
+        // a read-only asset directory only costs the next launch a parse and a simplification
+        mesh_cache_write(cache_filename, filename, levels, mesh->num_lods + 1);
+    } else {
+        fprintf(stderr, "Error opening %s.\n", filename);
+    }
+
+    vertex_soa_build(&mesh->positions, mesh->vertices, array_length(mesh->vertices));
+    compute_mesh_bounds(mesh);
+}
+
+void load_grid_mesh_data(mesh_t* mesh, int columns, int rows) {
+    release_mesh_geometry(mesh);
+
+    for (int y=0; y<=rows; y++) {
+        for (int x=0; x<=columns; x++) {
+            float u = (float) x / columns * 2 - 1;
+            float v = (float) y / rows * 2 - 1;
+            // a few ripples so the depth of neighboring faces differs
+            vec3_t vertex = { u, v, 0.05f * sinf(u * 9) * cosf(v * 7) };
+            array_push(mesh->vertices, vertex);
+        }
     }
+
+    for (int y=0; y<rows; y++) {
+        for (int x=0; x<columns; x++) {
+            int a = y * (columns + 1) + x;
+            int b = a + 1;
+            int c = a + columns + 1;
+            int d = c + 1;
+            // checkered, so the triangles are told apart when filled
+            uint32_t color = (x + y) % 2 ? 0xFFC0C0C0 : 0xFF808080;
+            // the texture covers the whole grid once
+            tex2_t uv_a = { (float) x / columns, (float) y / rows };
+            tex2_t uv_b = { (float) (x + 1) / columns, (float) y / rows };
+            tex2_t uv_c = { (float) x / columns, (float) (y + 1) / rows };
+            tex2_t uv_d = { (float) (x + 1) / columns, (float) (y + 1) / rows };
+            face_t first = { .a = a, .b = c, .c = b, .a_uv = uv_a, .b_uv = uv_c, .c_uv = uv_b, .color = color };
+            face_t second = { .a = b, .b = c, .c = d, .a_uv = uv_b, .b_uv = uv_c, .c_uv = uv_d, .color = color };
+            array_push(mesh->faces, first);
+            array_push(mesh->faces, second);
+        }
+    }
+    optimize_mesh(&mesh->vertices, &mesh->faces, NULL);
+
+    vertex_soa_build(&mesh->positions, mesh->vertices, array_length(mesh->vertices));
+    compute_mesh_bounds(mesh);
 }
 
-void load_obj_file_data(char* filename) {
+// the original fgets + sscanf loader, only kept as the baseline for the load benchmark
+void load_obj_file_data_stdio(mesh_t* mesh, char* filename) {
     // read the contents of the .obj file
     // load the vertices and faces into the mesh object
+    release_mesh_geometry(mesh);
 
     FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error opening %s.\n", filename);
+        return;
+    }
 
     char buf[255];
 
@@ -72,7 +198,7 @@ void load_obj_file_data(char* filename) {
                     .y = b,
                     .z = c
                 };
-                array_push(mesh.vertices, v);
+                array_push(mesh->vertices, v);
             } else if (buf[1] == 't') {
                 // textures
             } else if (buf[1] == 'n') {
@@ -91,14 +217,75 @@ void load_obj_file_data(char* filename) {
             );
 
             face_t face = {
-                .a = av,
-                .b = bv,
-                .c = cv
+                .a = av - 1,
+                .b = bv - 1,
+                .c = cv - 1
             };
 
-            array_push(mesh.faces, face);
+            array_push(mesh->faces, face);
         }
     }
 
     fclose(file);
-}
\ No newline at end of file
+
+    vertex_soa_build(&mesh->positions, mesh->vertices, array_length(mesh->vertices));
+    compute_mesh_bounds(mesh);
+}
+
+void build_mesh_lods(mesh_t* mesh) {
+    if (mesh->cache.base) {
+        return;
+    }
+    free_mesh_lods(mesh);
+
+    int targets[MESH_MAX_LODS];
+    int num_targets = 0;
+    int num_faces = array_length(mesh->faces);
+    while (num_targets < MESH_MAX_LODS && num_faces / 2 >= MESH_LOD_MIN_FACES) {
+        num_faces /= 2;
+        targets[num_targets++] = num_faces;
+    }
+    if (num_targets == 0) {
+        return;
+    }
+
+    simplified_mesh_t levels[MESH_MAX_LODS];
+    mesh->num_lods = simplify_mesh(mesh->vertices, mesh->faces, targets, num_targets, levels);
+    for (int i=0; i<mesh->num_lods; i++) {
+        mesh->lods[i].vertices = levels[i].vertices;
+        mesh->lods[i].faces = levels[i].faces;
+        mesh->lods[i].error = levels[i].error;
+        vertex_soa_build(&mesh->lods[i].positions, levels[i].vertices, array_length(levels[i].vertices));
+    }
+}
+
+void build_mesh_meshlets(mesh_t* mesh) {
+    // the faces of a cached mesh are mapped, and already in the order of the meshlets stored with them
+    if (mesh->cache.base) {
+        return;
+    }
+    array_free(mesh->meshlets);
+    mesh->meshlets = build_meshlets(mesh->vertices, mesh->faces);
+    for (int i=0; i<mesh->num_lods; i++) {
+        array_free(mesh->lods[i].meshlets);
+        mesh->lods[i].meshlets = build_meshlets(mesh->lods[i].vertices, mesh->lods[i].faces);
+    }
+}
+
+const meshlet_t* mesh_level_meshlets(const mesh_t* mesh, int level) {
+    return level == 0 ? mesh->meshlets : mesh->lods[level - 1].meshlets;
+}
+
+const face_t* mesh_level_faces(const mesh_t* mesh, int level) {
+    return level == 0 ? mesh->faces : mesh->lods[level - 1].faces;
+}
+
+const vertex_soa_t* mesh_level_positions(const mesh_t* mesh, int level) {
+    return level == 0 ? &mesh->positions : &mesh->lods[level - 1].positions;
+}
+
+// releases the loaded geometry, the mesh can be loaded into again afterwards
+void free_mesh_data(mesh_t* mesh) {
+    release_mesh_geometry(mesh);
+    vertex_soa_free(&mesh->positions);
+}
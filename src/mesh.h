@@ -3,26 +3,60 @@
 
 #include "vector.h"
 #include "triangle.h"
+#include "transform.h"
+#include "mesh_cache.h"
+#include "bounds.h"
+#include "meshlet.h"
 
 #define N_CUBE_VERTICES 8 // a cube has 8 vertices
 #define N_CUBE_FACES (6 * 2) // 6 faces of the cube and 2 triangles per face
 
+// simplified levels kept per mesh, each has about half the faces of the one before
+// the cache stores them after the full mesh
+#define MESH_MAX_LODS (MESH_CACHE_MAX_LEVELS - 1)
+// meshes smaller than this aren't worth simplifying further
+#define MESH_LOD_MIN_FACES 32
+
 extern vec3_t cube_vertices[N_CUBE_VERTICES];
 extern face_t cube_faces[N_CUBE_FACES];
 
-// defines a mesh
+// a simplified copy of a mesh
+typedef struct {
+    vec3_t* vertices;
+    face_t* faces;
+    vertex_soa_t positions;
+    meshlet_t* meshlets;
+    float error;        // how far, in model units, it can be from the full mesh surface
+} mesh_lod_t;
+
+// defines a mesh, only the geometry: where it's placed is up to the scene instances using it
 typedef struct {
     vec3_t* vertices;   // dynamic array of vertices
     face_t* faces;      // dynamic array of faces
-    vec3_t rotation;    // the rotation info / euler angles
-    vec3_t scale;
-    vec3_t translation;
+    vertex_soa_t positions; // soa copy of vertices for the simd transform kernels
+    mesh_cache_t cache;     // when loaded from a cache file, vertices, faces, meshlets and the lods point into it and can't grow
+    aabb_t bounds;              // model space, computed at load time
+    bounding_sphere_t sphere;
+    meshlet_t* meshlets;        // over faces, which are reordered to match, NULL until built
+    mesh_lod_t lods[MESH_MAX_LODS]; // level i + 1, level 0 is the mesh itself
+    int num_lods;
 } mesh_t;
 
-// actual mesh that will be used
-extern mesh_t mesh;
-
-void load_cube_mesh_data(void);
-void load_obj_file_data(char* filename);
+void load_cube_mesh_data(mesh_t* mesh);
+// synthetic rippled square in the xy plane spanning [-1, 1], columns x rows cells of two triangles each
+void load_grid_mesh_data(mesh_t* mesh, int columns, int rows);
+// loads the mesh, its lods and their meshlets from <filename>.cache,
+// or parses the .obj, builds the lods and meshlets and writes the cache
+void load_obj_file_data(mesh_t* mesh, char* filename);
+void load_obj_file_data_stdio(mesh_t* mesh, char* filename);
+// fills lods from the loaded geometry, replacing any earlier ones; a mesh mapped from a cache keeps the file's
+void build_mesh_lods(mesh_t* mesh);
+// splits every level into meshlets, call after build_mesh_lods; a mesh mapped from a cache keeps the file's
+void build_mesh_meshlets(mesh_t* mesh);
+// level 0 is the full mesh, 1 to num_lods the simplified copies
+const face_t* mesh_level_faces(const mesh_t* mesh, int level);
+const meshlet_t* mesh_level_meshlets(const mesh_t* mesh, int level);
+const vertex_soa_t* mesh_level_positions(const mesh_t* mesh, int level);
+void free_mesh_data(mesh_t* mesh);
 
 #endif
\ No newline at end of file
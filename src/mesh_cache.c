@@ -0,0 +1,283 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include "mesh_cache.h"
+#include "array.h"
+
+// the array.h header in front of each block
+#define MESH_CACHE_BLOCK_HEADER_SIZE (2 * sizeof(int))
+
+size_t align8(size_t size) {
+    return (size + 7) & ~(size_t) 7;
+}
+
+size_t mesh_cache_vertex_block_size(int num_vertices) {
+    return align8(MESH_CACHE_BLOCK_HEADER_SIZE + sizeof(vec3_t) * num_vertices);
+}
+
+size_t mesh_cache_face_block_size(int num_faces) {
+    return align8(MESH_CACHE_BLOCK_HEADER_SIZE + sizeof(face_t) * num_faces);
+}
+
+size_t mesh_cache_meshlet_block_size(int num_meshlets) {
+    return align8(MESH_CACHE_BLOCK_HEADER_SIZE + sizeof(meshlet_t) * num_meshlets);
+}
+
+size_t mesh_cache_level_size(const mesh_cache_level_header_t* level) {
+    return mesh_cache_vertex_block_size(level->num_vertices) +
+        mesh_cache_face_block_size(level->num_faces) +
+        mesh_cache_meshlet_block_size(level->num_meshlets);
+}
+
+// fnv-1a over 64-bit words, the blocks are 8-byte aligned and padded
+uint64_t mesh_cache_checksum(const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*) data;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i=0; i+8<=size; i+=8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// every face corner names one of the vertices, so nothing indexing through the faces can go out of bounds
+bool mesh_cache_faces_valid(const face_t* faces, int num_faces, int num_vertices) {
+    for (int i=0; i<num_faces; i++) {
+        if ((unsigned) faces[i].a >= (unsigned) num_vertices ||
+            (unsigned) faces[i].b >= (unsigned) num_vertices ||
+            (unsigned) faces[i].c >= (unsigned) num_vertices) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// every meshlet is a run inside the level's faces
+bool mesh_cache_meshlets_valid(const meshlet_t* meshlets, int num_meshlets, int num_faces) {
+    for (int i=0; i<num_meshlets; i++) {
+        if (meshlets[i].first_face < 0 || meshlets[i].num_faces < 0 || meshlets[i].first_face > num_faces - meshlets[i].num_faces) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool source_file_stat(const char* filename, uint64_t* size, int64_t* mtime) {
+    struct stat st;
+    if (stat(filename, &st) != 0) {
+        return false;
+    }
+    *size = (uint64_t) st.st_size;
+    *mtime = (int64_t) st.st_mtime;
+    return true;
+}
+
+// private, writable mapping: writes to the mesh only touch this process' copy of the pages
+bool mesh_cache_map(const char* filename, mesh_cache_t* cache) {
+    memset(cache, 0, sizeof(mesh_cache_t));
+
+#if !defined(_WIN32)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(mesh_cache_header_t)) {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    cache->base = base;
+    cache->size = st.st_size;
+    cache->mapped = true;
+    return true;
+#else
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < (long) sizeof(mesh_cache_header_t)) {
+        fclose(f);
+        return false;
+    }
+
+    cache->base = malloc(size);
+    cache->size = fread(cache->base, 1, size, f);
+    fclose(f);
+    return true;
+#endif
+}
+
+void mesh_cache_release(mesh_cache_t* cache) {
+#if !defined(_WIN32)
+    if (cache->mapped) {
+        munmap(cache->base, cache->size);
+    }
+#else
+    free(cache->base);
+#endif
+    memset(cache, 0, sizeof(mesh_cache_t));
+}
+
+bool mesh_cache_load(const char* cache_filename, const char* source_filename, mesh_cache_t* cache, mesh_cache_level_t* levels, int* num_levels) {
+    uint64_t source_size;
+    int64_t source_mtime;
+    if (!source_file_stat(source_filename, &source_size, &source_mtime)) {
+        return false;
+    }
+
+    if (!mesh_cache_map(cache_filename, cache)) {
+        return false;
+    }
+
+    const mesh_cache_header_t* header = (const mesh_cache_header_t*) cache->base;
+    bool valid = memcmp(header->magic, MESH_CACHE_MAGIC, 4) == 0 &&
+        header->version == MESH_CACHE_VERSION &&
+        header->vertex_size == sizeof(vec3_t) &&
+        header->face_size == sizeof(face_t) &&
+        header->meshlet_size == sizeof(meshlet_t) &&
+        header->num_levels >= 1 &&
+        header->num_levels <= MESH_CACHE_MAX_LEVELS &&
+        header->source_size == source_size &&
+        header->source_mtime == source_mtime;
+
+    size_t blocks_size = 0;
+    for (int i=0; valid && i<header->num_levels; i++) {
+        const mesh_cache_level_header_t* level = &header->levels[i];
+        valid = level->num_vertices >= 0 && level->num_faces >= 0 && level->num_meshlets >= 0;
+        blocks_size += valid ? mesh_cache_level_size(level) : 0;
+    }
+    valid = valid && cache->size == sizeof(mesh_cache_header_t) + blocks_size;
+
+    uint8_t* blocks = (uint8_t*) cache->base + sizeof(mesh_cache_header_t);
+    valid = valid && mesh_cache_checksum(blocks, blocks_size) == header->checksum;
+
+    // the data starts right after each block's array.h header
+    uint8_t* block = blocks;
+    for (int i=0; valid && i<header->num_levels; i++) {
+        const mesh_cache_level_header_t* level = &header->levels[i];
+        vec3_t* vertex_items = (vec3_t*) (block + MESH_CACHE_BLOCK_HEADER_SIZE);
+        block += mesh_cache_vertex_block_size(level->num_vertices);
+        face_t* face_items = (face_t*) (block + MESH_CACHE_BLOCK_HEADER_SIZE);
+        block += mesh_cache_face_block_size(level->num_faces);
+        meshlet_t* meshlet_items = (meshlet_t*) (block + MESH_CACHE_BLOCK_HEADER_SIZE);
+        block += mesh_cache_meshlet_block_size(level->num_meshlets);
+
+        // a file from another build can pass the checksum and still hold indices this one can't use
+        valid = mesh_cache_faces_valid(face_items, level->num_faces, level->num_vertices) &&
+            mesh_cache_meshlets_valid(meshlet_items, level->num_meshlets, level->num_faces);
+        levels[i].vertices = level->num_vertices > 0 ? vertex_items : NULL;
+        levels[i].faces = level->num_faces > 0 ? face_items : NULL;
+        levels[i].meshlets = level->num_meshlets > 0 ? meshlet_items : NULL;
+        levels[i].error = level->error;
+    }
+
+    if (!valid) {
+        mesh_cache_release(cache);
+        return false;
+    }
+
+    *num_levels = header->num_levels;
+    return true;
+}
+
+// array.h header, items and zero padding up to block_size
+void fill_block(uint8_t* buffer, const void* items, int count, size_t item_size, size_t block_size) {
+    int array_header[2] = { count, count }; // capacity, length
+    memset(buffer, 0, block_size);
+    memcpy(buffer, array_header, sizeof(array_header));
+    if (count > 0) {
+        memcpy(buffer + MESH_CACHE_BLOCK_HEADER_SIZE, items, item_size * count);
+    }
+}
+
+bool mesh_cache_write(const char* cache_filename, const char* source_filename, const mesh_cache_level_t* levels, int num_levels) {
+    if (num_levels < 1 || num_levels > MESH_CACHE_MAX_LEVELS) {
+        return false;
+    }
+
+    mesh_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+    header.version = MESH_CACHE_VERSION;
+    header.vertex_size = sizeof(vec3_t);
+    header.face_size = sizeof(face_t);
+    header.meshlet_size = sizeof(meshlet_t);
+    header.num_levels = num_levels;
+    if (!source_file_stat(source_filename, &header.source_size, &header.source_mtime)) {
+        return false;
+    }
+
+    size_t blocks_size = 0;
+    for (int i=0; i<num_levels; i++) {
+        mesh_cache_level_header_t* level = &header.levels[i];
+        level->num_vertices = array_length(levels[i].vertices);
+        level->num_faces = array_length(levels[i].faces);
+        level->num_meshlets = array_length(levels[i].meshlets);
+        level->error = levels[i].error;
+        blocks_size += mesh_cache_level_size(level);
+    }
+
+    // every block is built in memory first, the checksum needs them anyway
+    uint8_t* blocks = (uint8_t*) malloc(blocks_size);
+    uint8_t* block = blocks;
+    for (int i=0; i<num_levels; i++) {
+        const mesh_cache_level_header_t* level = &header.levels[i];
+        size_t vertex_block_size = mesh_cache_vertex_block_size(level->num_vertices);
+        size_t face_block_size = mesh_cache_face_block_size(level->num_faces);
+        size_t meshlet_block_size = mesh_cache_meshlet_block_size(level->num_meshlets);
+        fill_block(block, levels[i].vertices, level->num_vertices, sizeof(vec3_t), vertex_block_size);
+        block += vertex_block_size;
+        fill_block(block, levels[i].faces, level->num_faces, sizeof(face_t), face_block_size);
+        block += face_block_size;
+        fill_block(block, levels[i].meshlets, level->num_meshlets, sizeof(meshlet_t), meshlet_block_size);
+        block += meshlet_block_size;
+    }
+    header.checksum = mesh_cache_checksum(blocks, blocks_size);
+
+    char temporary_filename[1024];
+    snprintf(temporary_filename, sizeof(temporary_filename), "%s.tmp", cache_filename);
+
+    FILE* file = fopen(temporary_filename, "wb");
+    if (!file) {
+        free(blocks);
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(blocks, blocks_size, 1, file) == 1;
+    written = fclose(file) == 0 && written;
+    free(blocks);
+
+#if defined(_WIN32)
+    // rename does not replace an existing file there
+    remove(cache_filename);
+#endif
+    if (!written || rename(temporary_filename, cache_filename) != 0) {
+        remove(temporary_filename);
+        return false;
+    }
+    return true;
+}
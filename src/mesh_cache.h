@@ -0,0 +1,64 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "vector.h"
+#include "triangle.h"
+#include "meshlet.h"
+
+#define MESH_CACHE_MAGIC "RMSH"
+#define MESH_CACHE_VERSION 5
+#define MESH_CACHE_EXTENSION ".cache"
+// the full mesh and its simplified levels
+#define MESH_CACHE_MAX_LEVELS 7
+
+typedef struct {
+    int32_t num_vertices;
+    int32_t num_faces;
+    int32_t num_meshlets;
+    float error;
+} mesh_cache_level_header_t;
+
+// file layout: header, then the vertex, face and meshlet blocks of every level in order, each one laid out exactly
+// like an array.h dynamic array (int capacity, int length, items) so they can be used in place
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertex_size;   // sizeof(vec3_t), sizeof(face_t) and sizeof(meshlet_t) of the writer
+    uint32_t face_size;
+    uint32_t meshlet_size;
+    int32_t num_levels;
+    mesh_cache_level_header_t levels[MESH_CACHE_MAX_LEVELS];
+    uint64_t source_size;   // the .obj this was built from, the cache is stale once it changes
+    int64_t source_mtime;
+    uint64_t checksum;      // over everything after the header
+} mesh_cache_header_t;
+
+// one level's arrays, array.h arrays when written and pointers into the file when loaded
+typedef struct {
+    vec3_t* vertices;
+    face_t* faces;      // already in meshlet order
+    meshlet_t* meshlets;
+    float error;        // 0 for the full mesh
+} mesh_cache_level_t;
+
+// a loaded cache file, owns the memory the mesh arrays point into
+typedef struct {
+    void* base;
+    size_t size;
+    bool mapped;    // false when the file had to be read into a malloc'd buffer
+} mesh_cache_t;
+
+// maps the cache and points the arrays of every level into it without copying, levels holds MESH_CACHE_MAX_LEVELS
+// fails if the file is missing, corrupt, from another version, older than source_filename
+// or has a face corner outside its level's vertices or a meshlet outside its level's faces
+bool mesh_cache_load(const char* cache_filename, const char* source_filename, mesh_cache_t* cache, mesh_cache_level_t* levels, int* num_levels);
+
+// writes a cache of the levels for source_filename, through a temporary file so readers never see half of it
+bool mesh_cache_write(const char* cache_filename, const char* source_filename, const mesh_cache_level_t* levels, int num_levels);
+
+void mesh_cache_release(mesh_cache_t* cache);
+
+#endif
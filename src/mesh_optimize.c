@@ -0,0 +1,305 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mesh_optimize.h"
+#include "array.h"
+
+uint32_t optimize_hash(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t h = a * 0x8da6b343u ^ b * 0xd8163841u ^ c * 0xcb1ab31fu;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+// smallest power of two holding count entries at most half full
+int optimize_table_size(int count) {
+    int size = 16;
+    while (size < count * 2) {
+        size *= 2;
+    }
+    return size;
+}
+
+uint32_t optimize_float_bits(float f) {
+    // 0 and -0 are the same position
+    if (f == 0) {
+        f = 0;
+    }
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+// maps every vertex to the first one with the same position, returns how many distinct positions there are
+// weld_to[i] is the index of the vertex among the distinct ones
+int optimize_weld_vertices(const vec3_t* vertices, int num_vertices, int* weld_to, vec3_t* unique) {
+    int size = optimize_table_size(num_vertices);
+    int* table = (int*) malloc(sizeof(int) * size);
+    memset(table, -1, sizeof(int) * size);
+
+    int num_unique = 0;
+    for (int i=0; i<num_vertices; i++) {
+        uint32_t x = optimize_float_bits(vertices[i].x);
+        uint32_t y = optimize_float_bits(vertices[i].y);
+        uint32_t z = optimize_float_bits(vertices[i].z);
+
+        int slot = optimize_hash(x, y, z) & (size - 1);
+        while (table[slot] != -1) {
+            vec3_t other = unique[table[slot]];
+            if (optimize_float_bits(other.x) == x && optimize_float_bits(other.y) == y && optimize_float_bits(other.z) == z) {
+                break;
+            }
+            slot = (slot + 1) & (size - 1);
+        }
+
+        if (table[slot] == -1) {
+            table[slot] = num_unique;
+            unique[num_unique++] = vertices[i];
+        }
+        weld_to[i] = table[slot];
+    }
+
+    free(table);
+    return num_unique;
+}
+
+bool optimize_face_degenerate(const vec3_t* vertices, face_t face) {
+    if (face.a == face.b || face.b == face.c || face.a == face.c) {
+        return true;
+    }
+    vec3_t normal = vec3_cross(vec3_sub(vertices[face.b], vertices[face.a]), vec3_sub(vertices[face.c], vertices[face.a]));
+    return normal.x == 0 && normal.y == 0 && normal.z == 0;
+}
+
+// the same corners in the same winding, starting from the smallest index
+face_t optimize_face_canonical(face_t face) {
+    if (face.b < face.a && face.b < face.c) {
+        return (face_t){ .a = face.b, .b = face.c, .c = face.a, .a_uv = face.b_uv, .b_uv = face.c_uv, .c_uv = face.a_uv, .color = face.color };
+    }
+    if (face.c < face.a && face.c < face.b) {
+        return (face_t){ .a = face.c, .b = face.a, .c = face.b, .a_uv = face.c_uv, .b_uv = face.a_uv, .c_uv = face.b_uv, .color = face.color };
+    }
+    return face;
+}
+
+// drops degenerate and duplicate faces in place, returns how many are left
+int optimize_filter_faces(const vec3_t* vertices, face_t* faces, int num_faces, mesh_optimize_stats_t* stats) {
+    int size = optimize_table_size(num_faces);
+    int* table = (int*) malloc(sizeof(int) * size);
+    memset(table, -1, sizeof(int) * size);
+
+    int num_kept = 0;
+    for (int f=0; f<num_faces; f++) {
+        face_t face = optimize_face_canonical(faces[f]);
+        if (optimize_face_degenerate(vertices, face)) {
+            stats->degenerate_faces++;
+            continue;
+        }
+
+        int slot = optimize_hash(face.a, face.b, face.c) & (size - 1);
+        bool duplicate = false;
+        while (table[slot] != -1) {
+            face_t other = faces[table[slot]];
+            if (other.a == face.a && other.b == face.b && other.c == face.c) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & (size - 1);
+        }
+        if (duplicate) {
+            stats->duplicate_faces++;
+            continue;
+        }
+
+        // kept faces are compacted towards the front, never past an unread one
+        table[slot] = num_kept;
+        faces[num_kept++] = face;
+    }
+
+    free(table);
+    return num_kept;
+}
+
+// tipsify: fans around one vertex at a time, moving on to the neighbor that is still in the
+// simulated cache and has the fewest faces left, or back to a recent vertex at a dead end
+// writes the new face order into order
+void optimize_order_faces(const face_t* faces, int num_faces, int num_vertices, int* order) {
+    int* offsets = (int*) calloc(num_vertices + 1, sizeof(int));
+    for (int f=0; f<num_faces; f++) {
+        offsets[faces[f].a + 1]++;
+        offsets[faces[f].b + 1]++;
+        offsets[faces[f].c + 1]++;
+    }
+    int max_valence = 0;
+    for (int v=0; v<num_vertices; v++) {
+        max_valence = offsets[v + 1] > max_valence ? offsets[v + 1] : max_valence;
+        offsets[v + 1] += offsets[v];
+    }
+
+    int* vertex_faces = (int*) malloc(sizeof(int) * 3 * num_faces);
+    int* live = (int*) malloc(sizeof(int) * num_vertices);
+    for (int v=0; v<num_vertices; v++) {
+        live[v] = offsets[v + 1] - offsets[v];
+    }
+    int* fill = (int*) malloc(sizeof(int) * num_vertices);
+    memcpy(fill, offsets, sizeof(int) * num_vertices);
+    for (int f=0; f<num_faces; f++) {
+        vertex_faces[fill[faces[f].a]++] = f;
+        vertex_faces[fill[faces[f].b]++] = f;
+        vertex_faces[fill[faces[f].c]++] = f;
+    }
+    free(fill);
+
+    int* cache_time = (int*) calloc(num_vertices, sizeof(int));
+    bool* emitted = (bool*) calloc(num_faces, sizeof(bool));
+    int* dead_ends = (int*) malloc(sizeof(int) * 3 * num_faces);
+    int* candidates = (int*) malloc(sizeof(int) * 3 * max_valence);
+    int num_dead_ends = 0;
+    int num_ordered = 0;
+    int time = MESH_OPTIMIZE_CACHE_SIZE + 1;
+    int cursor = 0;
+
+    int fan = num_faces > 0 ? faces[0].a : -1;
+    while (fan >= 0) {
+        int num_candidates = 0;
+        for (int k=offsets[fan]; k<offsets[fan + 1]; k++) {
+            int f = vertex_faces[k];
+            if (emitted[f]) {
+                continue;
+            }
+            emitted[f] = true;
+            order[num_ordered++] = f;
+
+            int corners[3] = { faces[f].a, faces[f].b, faces[f].c };
+            for (int j=0; j<3; j++) {
+                int v = corners[j];
+                dead_ends[num_dead_ends++] = v;
+                candidates[num_candidates++] = v;
+                live[v]--;
+                if (time - cache_time[v] > MESH_OPTIMIZE_CACHE_SIZE) {
+                    cache_time[v] = time++;
+                }
+            }
+        }
+
+        // the candidate that stays in the cache while its remaining faces are emitted, the oldest such one
+        int next = -1;
+        int best = -1;
+        for (int i=0; i<num_candidates; i++) {
+            int v = candidates[i];
+            if (live[v] <= 0) {
+                continue;
+            }
+            int priority = 0;
+            if (time - cache_time[v] + 2 * live[v] <= MESH_OPTIMIZE_CACHE_SIZE) {
+                priority = time - cache_time[v];
+            }
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+
+        // dead end: the most recently used vertex with faces left, then the next one in index order
+        while (next == -1 && num_dead_ends > 0) {
+            int v = dead_ends[--num_dead_ends];
+            if (live[v] > 0) {
+                next = v;
+            }
+        }
+        while (next == -1 && cursor < num_vertices) {
+            if (live[cursor] > 0) {
+                next = cursor;
+            }
+            cursor++;
+        }
+        fan = next;
+    }
+
+    free(candidates);
+    free(dead_ends);
+    free(emitted);
+    free(cache_time);
+    free(live);
+    free(vertex_faces);
+    free(offsets);
+}
+
+void optimize_mesh(vec3_t** vertices, face_t** faces, mesh_optimize_stats_t* stats) {
+    mesh_optimize_stats_t local_stats;
+    if (!stats) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    int num_vertices = array_length(*vertices);
+    int num_faces = array_length(*faces);
+    stats->vertices_before = num_vertices;
+    stats->faces_before = num_faces;
+
+    int* weld_to = (int*) malloc(sizeof(int) * (num_vertices > 0 ? num_vertices : 1));
+    vec3_t* unique = (vec3_t*) malloc(sizeof(vec3_t) * (num_vertices > 0 ? num_vertices : 1));
+    int num_unique = optimize_weld_vertices(*vertices, num_vertices, weld_to, unique);
+    stats->welded_vertices = num_vertices - num_unique;
+
+    face_t* welded_faces = (face_t*) malloc(sizeof(face_t) * (num_faces > 0 ? num_faces : 1));
+    for (int f=0; f<num_faces; f++) {
+        face_t face = (*faces)[f];
+        face.a = weld_to[face.a];
+        face.b = weld_to[face.b];
+        face.c = weld_to[face.c];
+        welded_faces[f] = face;
+    }
+    int num_kept = optimize_filter_faces(unique, welded_faces, num_faces, stats);
+
+    int* order = (int*) malloc(sizeof(int) * (num_kept > 0 ? num_kept : 1));
+    optimize_order_faces(welded_faces, num_kept, num_unique, order);
+
+    // vertices in the order the faces first use them, anything left unused goes away
+    int* remap = (int*) malloc(sizeof(int) * (num_unique > 0 ? num_unique : 1));
+    memset(remap, -1, sizeof(int) * num_unique);
+    int num_used = 0;
+    vec3_t* new_vertices = NULL;
+    face_t* new_faces = NULL;
+    if (num_kept > 0) {
+        new_faces = (face_t*) array_hold(NULL, num_kept, sizeof(face_t));
+    }
+    for (int i=0; i<num_kept; i++) {
+        face_t face = welded_faces[order[i]];
+        int corners[3] = { face.a, face.b, face.c };
+        for (int j=0; j<3; j++) {
+            if (remap[corners[j]] == -1) {
+                remap[corners[j]] = num_used++;
+            }
+            corners[j] = remap[corners[j]];
+        }
+        face.a = corners[0];
+        face.b = corners[1];
+        face.c = corners[2];
+        new_faces[i] = face;
+    }
+    if (num_used > 0) {
+        new_vertices = (vec3_t*) array_hold(NULL, num_used, sizeof(vec3_t));
+    }
+    for (int v=0; v<num_unique; v++) {
+        if (remap[v] != -1) {
+            new_vertices[remap[v]] = unique[v];
+        }
+    }
+
+    stats->unused_vertices = num_unique - num_used;
+    stats->vertices_after = num_used;
+    stats->faces_after = num_kept;
+
+    array_free(*vertices);
+    array_free(*faces);
+    *vertices = new_vertices;
+    *faces = new_faces;
+
+    free(remap);
+    free(order);
+    free(welded_faces);
+    free(unique);
+    free(weld_to);
+}
@@ -0,0 +1,28 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include "vector.h"
+#include "triangle.h"
+
+// recently used vertices the face order tries to stay within, about what fits a few cache lines of every stream array
+#define MESH_OPTIMIZE_CACHE_SIZE 16
+
+// what one optimization pass changed
+typedef struct {
+    int vertices_before;
+    int vertices_after;
+    int faces_before;
+    int faces_after;
+    int welded_vertices;        // merged into an earlier vertex at the same position
+    int unused_vertices;        // not referenced by any remaining face
+    int degenerate_faces;       // repeated corners or zero area
+    int duplicate_faces;        // same corners in the same winding as an earlier face
+} mesh_optimize_stats_t;
+
+// welds vertices with identical positions, drops degenerate and duplicate faces, then orders the faces
+// so neighbors share recently used vertices (tipsify, Sander et al. 2007) and the vertices by first use,
+// so consecutive faces read nearby entries of the vertex stream
+// vertices and faces are array.h arrays with 0-based indices, they are replaced by new ones, stats can be NULL
+void optimize_mesh(vec3_t** vertices, face_t** faces, mesh_optimize_stats_t* stats);
+
+#endif
@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "meshlet.h"
+#include "array.h"
+
+// unit normal in the same winding the backface test uses, zero for degenerate faces
+vec3_t meshlet_face_normal(const vec3_t* vertices, face_t face) {
+    vec3_t a = vertices[face.a];
+    vec3_t ab = vec3_sub(vertices[face.b], a);
+    vec3_t ac = vec3_sub(vertices[face.c], a);
+    vec3_t normal = vec3_cross(ab, ac);
+    float length = vec3_length(normal);
+    return length > 0 ? vec3_div(normal, length) : (vec3_t){ 0, 0, 0 };
+}
+
+void compute_meshlet_bounds(meshlet_t* meshlet, const vec3_t* vertices, const face_t* faces, const vec3_t* normals) {
+    aabb_t box = aabb_empty();
+    vec3_t normal_sum = { 0, 0, 0 };
+    for (int i=meshlet->first_face; i<meshlet->first_face + meshlet->num_faces; i++) {
+        int corners[3] = { faces[i].a, faces[i].b, faces[i].c };
+        for (int j=0; j<3; j++) {
+            box = aabb_union(box, (aabb_t){ vertices[corners[j]], vertices[corners[j]] });
+        }
+        normal_sum = vec3_add(normal_sum, normals[i]);
+    }
+
+    meshlet->sphere.center = aabb_center(box);
+    meshlet->sphere.radius = 0;
+    for (int i=meshlet->first_face; i<meshlet->first_face + meshlet->num_faces; i++) {
+        int corners[3] = { faces[i].a, faces[i].b, faces[i].c };
+        for (int j=0; j<3; j++) {
+            float distance = vec3_length(vec3_sub(vertices[corners[j]], meshlet->sphere.center));
+            meshlet->sphere.radius = fmaxf(meshlet->sphere.radius, distance);
+        }
+    }
+
+    float length = vec3_length(normal_sum);
+    if (length <= 0) {
+        meshlet->cone_axis = (vec3_t){ 0, 0, 1 };
+        meshlet->cone_cos = -1;
+        return;
+    }
+    meshlet->cone_axis = vec3_div(normal_sum, length);
+    meshlet->cone_cos = 1;
+    for (int i=meshlet->first_face; i<meshlet->first_face + meshlet->num_faces; i++) {
+        if (normals[i].x == 0 && normals[i].y == 0 && normals[i].z == 0) {
+            continue;   // no area, it can't be seen from any side
+        }
+        meshlet->cone_cos = fminf(meshlet->cone_cos, vec3_dot(meshlet->cone_axis, normals[i]));
+    }
+}
+
+meshlet_t* build_meshlets(const vec3_t* vertices, face_t* faces) {
+    int num_vertices = array_length((void*) vertices);
+    int num_faces = array_length(faces);
+    if (num_faces == 0) {
+        return NULL;
+    }
+
+    vec3_t* normals = (vec3_t*) malloc(sizeof(vec3_t) * num_faces);
+    for (int f=0; f<num_faces; f++) {
+        normals[f] = meshlet_face_normal(vertices, faces[f]);
+    }
+
+    // faces around every vertex, compressed into one array
+    int* vertex_offsets = (int*) calloc(num_vertices + 1, sizeof(int));
+    for (int f=0; f<num_faces; f++) {
+        vertex_offsets[faces[f].a + 1]++;
+        vertex_offsets[faces[f].b + 1]++;
+        vertex_offsets[faces[f].c + 1]++;
+    }
+    for (int v=0; v<num_vertices; v++) {
+        vertex_offsets[v + 1] += vertex_offsets[v];
+    }
+    int* vertex_faces = (int*) malloc(sizeof(int) * 3 * num_faces);
+    int* fill = (int*) malloc(sizeof(int) * (num_vertices + 1));
+    memcpy(fill, vertex_offsets, sizeof(int) * (num_vertices + 1));
+    for (int f=0; f<num_faces; f++) {
+        vertex_faces[fill[faces[f].a]++] = f;
+        vertex_faces[fill[faces[f].b]++] = f;
+        vertex_faces[fill[faces[f].c]++] = f;
+    }
+    free(fill);
+
+    bool* assigned = (bool*) calloc(num_faces, sizeof(bool));
+    // new face order, every meshlet's run doubles as its breadth first queue while it grows
+    int* order = (int*) malloc(sizeof(int) * num_faces);
+    int num_ordered = 0;
+    meshlet_t* meshlets = NULL;
+
+    for (int seed=0; seed<num_faces; seed++) {
+        if (assigned[seed]) {
+            continue;
+        }
+
+        int first = num_ordered;
+        assigned[seed] = true;
+        order[num_ordered++] = seed;
+        vec3_t normal_sum = normals[seed];
+
+        for (int q=first; q<num_ordered && num_ordered - first < MESHLET_MAX_FACES; q++) {
+            face_t face = faces[order[q]];
+            int corners[3] = { face.a, face.b, face.c };
+            for (int j=0; j<3 && num_ordered - first < MESHLET_MAX_FACES; j++) {
+                for (int k=vertex_offsets[corners[j]]; k<vertex_offsets[corners[j] + 1]; k++) {
+                    int candidate = vertex_faces[k];
+                    if (assigned[candidate]) {
+                        continue;
+                    }
+
+                    vec3_t n = normals[candidate];
+                    bool degenerate = n.x == 0 && n.y == 0 && n.z == 0;
+                    float sum_length = vec3_length(normal_sum);
+                    bool aligned = sum_length <= 0 || vec3_dot(n, normal_sum) >= MESHLET_MIN_NORMAL_DOT * sum_length;
+                    if (!degenerate && !aligned) {
+                        continue;
+                    }
+
+                    assigned[candidate] = true;
+                    order[num_ordered++] = candidate;
+                    normal_sum = vec3_add(normal_sum, n);
+                    if (num_ordered - first == MESHLET_MAX_FACES) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        meshlet_t meshlet = { .first_face = first, .num_faces = num_ordered - first };
+        array_push(meshlets, meshlet);
+    }
+
+    // faces in meshlet order, the normals follow them for the cones
+    face_t* reordered = (face_t*) malloc(sizeof(face_t) * num_faces);
+    vec3_t* reordered_normals = (vec3_t*) malloc(sizeof(vec3_t) * num_faces);
+    for (int i=0; i<num_faces; i++) {
+        reordered[i] = faces[order[i]];
+        reordered_normals[i] = normals[order[i]];
+    }
+    memcpy(faces, reordered, sizeof(face_t) * num_faces);
+
+    for (int m=0; m<array_length(meshlets); m++) {
+        compute_meshlet_bounds(&meshlets[m], vertices, faces, reordered_normals);
+    }
+
+    free(reordered);
+    free(reordered_normals);
+    free(order);
+    free(assigned);
+    free(vertex_faces);
+    free(vertex_offsets);
+    free(normals);
+    return meshlets;
+}
+
+bool meshlet_backfacing(vec3_t center, float radius, vec3_t axis, float cone_cos) {
+    if (cone_cos <= 0) {
+        return false;   // the normals spread over a half space or more
+    }
+
+    float distance = vec3_length(center);
+    if (distance <= radius) {
+        return false;   // the camera is inside the bounds, some face can always look at it
+    }
+
+    // every normal is within alpha of the axis, every point is within beta of the direction to the center
+    // so all faces point away when the center direction is within 90 - alpha - beta of the axis
+    float sin_alpha = sqrtf(1 - cone_cos * cone_cos);
+    float sin_beta = radius / distance;
+    float cos_beta = sqrtf(1 - sin_beta * sin_beta);
+
+    if (cone_cos * cos_beta - sin_alpha * sin_beta <= 0) {
+        return false;   // alpha + beta reaches 90 degrees
+    }
+    float sin_alpha_beta = sin_alpha * cos_beta + cone_cos * sin_beta;
+    return vec3_dot(center, axis) > sin_alpha_beta * distance;
+}
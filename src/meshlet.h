@@ -0,0 +1,32 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <stdbool.h>
+#include "vector.h"
+#include "triangle.h"
+#include "bounds.h"
+
+// faces per meshlet
+#define MESHLET_MAX_FACES 64
+// a face only joins a meshlet when its normal is this close (as a cosine) to the meshlet's average,
+// which keeps the cones narrow enough to reject anything
+#define MESHLET_MIN_NORMAL_DOT 0.5f
+
+// a run of neighboring faces that can be culled as a whole
+typedef struct {
+    int first_face;
+    int num_faces;
+    bounding_sphere_t sphere;   // model space, around the corners of its faces
+    vec3_t cone_axis;           // average face normal, unit length
+    float cone_cos;             // every face normal is within acos(cone_cos) of the axis, <= 0 never rejects
+} meshlet_t;
+
+// groups the faces into meshlets by growing each one across shared vertices from a seed face,
+// reordering faces in place so every meshlet is a contiguous run, returns an array.h array
+meshlet_t* build_meshlets(const vec3_t* vertices, face_t* faces);
+
+// true when every face of the meshlet points away from a camera at the origin
+// center, axis and radius must already be in view space
+bool meshlet_backfacing(vec3_t center, float radius, vec3_t axis, float cone_cos);
+
+#endif
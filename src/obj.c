@@ -0,0 +1,536 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "obj.h"
+#include "array.h"
+
+#define OBJ_MAX_CHUNKS 64
+
+typedef struct {
+    const char* data;
+    size_t size;
+    bool mapped;    // false when the data had to be read into a malloc'd buffer
+} obj_file_t;
+
+// one slice of the file, the passes only write into their own chunk
+typedef struct {
+    const char* begin;
+    const char* end;
+    int num_vertices;       // first pass: vertices, texture coordinates and triangles in this chunk
+    int num_texcoords;
+    int num_triangles;
+    int vertex_base;        // prefix sums over the previous chunks
+    int texcoord_base;
+    int triangle_base;
+    int total_vertices;
+    int total_texcoords;
+    vec3_t* vertices;       // second pass: shared output arrays
+    face_t* faces;
+    tex2_t* texcoords;      // every vt of the file, only needed until the faces have their corners' values
+    int* face_texcoords;    // 3 per triangle, 0-based vt of each corner or -1, resolved once every chunk is parsed; NULL without vt
+    int num_faces_written;  // lower than num_triangles when invalid faces were dropped
+} obj_chunk_t;
+
+bool obj_map_file(const char* filename, obj_file_t* file) {
+    memset(file, 0, sizeof(obj_file_t));
+
+#if !defined(_WIN32)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    file->size = (size_t) st.st_size;
+    if (file->size > 0) {
+        void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        // every chunk is touched right away by its own thread
+        posix_madvise(data, file->size, POSIX_MADV_WILLNEED);
+        file->data = (const char*) data;
+        file->mapped = true;
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+    return true;
+#else
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char* data = (char*) malloc(size > 0 ? size : 1);
+    file->size = fread(data, 1, size > 0 ? size : 0, f);
+    file->data = data;
+    fclose(f);
+    return true;
+#endif
+}
+
+void obj_unmap_file(obj_file_t* file) {
+#if !defined(_WIN32)
+    if (file->mapped) {
+        munmap((void*) file->data, file->size);
+    }
+#else
+    free((void*) file->data);
+#endif
+    memset(file, 0, sizeof(obj_file_t));
+}
+
+bool obj_is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool obj_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+const char* obj_skip_spaces(const char* p, const char* end) {
+    while (p < end && obj_is_space(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// returns the start of the next line
+const char* obj_skip_line(const char* p, const char* end) {
+    const char* newline = (const char*) memchr(p, '\n', end - p);
+    return newline ? newline + 1 : end;
+}
+
+bool obj_is_token_end(const char* p, const char* end) {
+    return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+}
+
+// decimal float with optional sign, fraction and exponent, returns NULL if there is no number
+const char* obj_parse_float(const char* p, const char* end, float* out) {
+    // 10^0 .. 10^22 are exact doubles, so mantissa * or / one of these is within a double ulp or two
+    // (up to 19 digits, the mantissa itself rounds past 2^53). The (float) cast rounds a second time,
+    // so the result is accurate to float precision, not correctly rounded: a value very close to halfway
+    // between two floats can come out one float ulp away from strtof's
+    static const double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+
+    for (; p < end && obj_is_digit(*p); p++) {
+        has_digits = true;
+        if (significant_digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            significant_digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && obj_is_digit(*p); p++) {
+            has_digits = true;
+            if (significant_digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                significant_digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!has_digits) {
+        return NULL;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negative_exponent = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            negative_exponent = *q == '-';
+            q++;
+        }
+        if (q < end && obj_is_digit(*q)) {
+            int e = 0;
+            for (; q < end && obj_is_digit(*q); q++) {
+                if (e < 10000) {
+                    e = e * 10 + (*q - '0');
+                }
+            }
+            exponent += negative_exponent ? -e : e;
+            p = q;
+        }
+    }
+
+    double value = (double) mantissa;
+    if (exponent >= 0 && exponent <= 22) {
+        value *= powers_of_ten[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+        value /= powers_of_ten[-exponent];
+    } else {
+        value *= pow(10.0, exponent);
+    }
+
+    *out = (float) (negative ? -value : value);
+    return p;
+}
+
+// decimal int with optional sign, returns NULL if there is no number
+const char* obj_parse_int(const char* p, const char* end, int* out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p >= end || !obj_is_digit(*p)) {
+        return NULL;
+    }
+
+    long long value = 0;
+    for (; p < end && obj_is_digit(*p); p++) {
+        if (value <= INT32_MAX) {
+            value = value * 10 + (*p - '0');
+        }
+    }
+    if (value > INT32_MAX) {
+        value = 0; // out of range either way, 0 is rejected as an index
+    }
+
+    *out = (int) (negative ? -value : value);
+    return p;
+}
+
+// the part of a line after its keyword, or NULL if the line is not a "keyword " line
+const char* obj_line_arguments(const char* p, const char* end, const char* keyword) {
+    size_t length = strlen(keyword);
+    if ((size_t) (end - p) > length && memcmp(p, keyword, length) == 0 && obj_is_space(p[length])) {
+        return p + length + 1;
+    }
+    return NULL;
+}
+
+int obj_count_face_corners(const char* p, const char* end) {
+    int corners = 0;
+    for (;;) {
+        p = obj_skip_spaces(p, end);
+        if (obj_is_token_end(p, end)) {
+            return corners;
+        }
+        corners++;
+        while (p < end && !obj_is_space(*p) && !obj_is_token_end(p, end)) {
+            p++;
+        }
+    }
+}
+
+// first pass: how many vertices and triangles this chunk will write
+int obj_count_chunk(void* data) {
+    obj_chunk_t* chunk = (obj_chunk_t*) data;
+    const char* end = chunk->end;
+
+    for (const char* line = chunk->begin; line < end; line = obj_skip_line(line, end)) {
+        const char* p = obj_skip_spaces(line, end);
+        const char* arguments;
+
+        if (obj_line_arguments(p, end, "v")) {
+            chunk->num_vertices++;
+        } else if (obj_line_arguments(p, end, "vt")) {
+            chunk->num_texcoords++;
+        } else if ((arguments = obj_line_arguments(p, end, "f"))) {
+            int corners = obj_count_face_corners(arguments, end);
+            if (corners >= 3) {
+                chunk->num_triangles += corners - 2;
+            }
+        }
+    }
+    return 0;
+}
+
+// second pass: parse into the chunk's slice of the shared arrays
+int obj_parse_chunk(void* data) {
+    obj_chunk_t* chunk = (obj_chunk_t*) data;
+    const char* end = chunk->end;
+    vec3_t* vertex = chunk->vertices + chunk->vertex_base;
+    tex2_t* texcoord = chunk->texcoords ? chunk->texcoords + chunk->texcoord_base : NULL;
+    face_t* faces = chunk->faces + chunk->triangle_base;
+    int* face_texcoords = chunk->face_texcoords ? chunk->face_texcoords + chunk->triangle_base * 3 : NULL;
+    int num_vertices_so_far = chunk->vertex_base;
+    int num_texcoords_so_far = chunk->texcoord_base;
+    int num_faces = 0;
+
+    for (const char* line = chunk->begin; line < end; line = obj_skip_line(line, end)) {
+        const char* p = obj_skip_spaces(line, end);
+        const char* arguments;
+
+        if ((arguments = obj_line_arguments(p, end, "v"))) {
+            // missing or malformed coordinates become 0, the vertex still has to exist for the indices
+            float xyz[3] = { 0, 0, 0 };
+            p = arguments;
+            for (int i=0; i<3; i++) {
+                const char* next = obj_parse_float(obj_skip_spaces(p, end), end, &xyz[i]);
+                if (!next) {
+                    break;
+                }
+                p = next;
+            }
+            vertex->x = xyz[0];
+            vertex->y = xyz[1];
+            vertex->z = xyz[2];
+            vertex++;
+            num_vertices_so_far++;
+        } else if ((arguments = obj_line_arguments(p, end, "vt"))) {
+            // a missing v is 0 like a missing coordinate, the optional w is ignored
+            float uv[2] = { 0, 0 };
+            p = arguments;
+            for (int i=0; i<2; i++) {
+                const char* next = obj_parse_float(obj_skip_spaces(p, end), end, &uv[i]);
+                if (!next) {
+                    break;
+                }
+                p = next;
+            }
+            texcoord->u = uv[0];
+            texcoord->v = uv[1];
+            texcoord++;
+            num_texcoords_so_far++;
+        } else if ((arguments = obj_line_arguments(p, end, "f"))) {
+            // "v", "v/t", "v//n" or "v/t/n" per corner, v and t are used
+            // the polygon is fanned around its first corner
+            int face_start = num_faces;
+            int first = 0, previous = 0;
+            int first_texcoord = -1, previous_texcoord = -1;
+            int corners = 0;
+            bool valid = true;
+
+            p = arguments;
+            for (;;) {
+                p = obj_skip_spaces(p, end);
+                if (obj_is_token_end(p, end)) {
+                    break;
+                }
+
+                int index = 0;
+                const char* next = obj_parse_int(p, end, &index);
+                if (next) {
+                    p = next;
+                }
+
+                // a corner with a missing or invalid t keeps the face, it just isn't textured there
+                int texcoord_index = 0;
+                if (face_texcoords && p < end && *p == '/' && (next = obj_parse_int(p + 1, end, &texcoord_index))) {
+                    p = next;
+                }
+                if (texcoord_index < 0) {
+                    texcoord_index = num_texcoords_so_far + texcoord_index + 1;
+                }
+                texcoord_index = texcoord_index >= 1 && texcoord_index <= chunk->total_texcoords ? texcoord_index - 1 : -1;
+
+                while (p < end && !obj_is_space(*p) && !obj_is_token_end(p, end)) {
+                    p++;
+                }
+
+                // negative indices count back from the last vertex defined so far
+                if (index < 0) {
+                    index = num_vertices_so_far + index + 1;
+                }
+                if (index < 1 || index > chunk->total_vertices) {
+                    valid = false;
+                }
+
+                // stored 0-based from here on
+                index--;
+                if (corners == 0) {
+                    first = index;
+                    first_texcoord = texcoord_index;
+                } else if (corners >= 2) {
+                    face_t face = {
+                        .a = first,
+                        .b = previous,
+                        .c = index
+                    };
+                    if (face_texcoords) {
+                        face_texcoords[num_faces * 3] = first_texcoord;
+                        face_texcoords[num_faces * 3 + 1] = previous_texcoord;
+                        face_texcoords[num_faces * 3 + 2] = texcoord_index;
+                    }
+                    faces[num_faces++] = face;
+                }
+                previous = index;
+                previous_texcoord = texcoord_index;
+                corners++;
+            }
+
+            if (!valid) {
+                num_faces = face_start;
+            }
+        }
+    }
+
+    chunk->num_faces_written = num_faces;
+    return 0;
+}
+
+// third pass: the texture coordinates of every face corner, which can be defined in any chunk
+int obj_resolve_chunk(void* data) {
+    obj_chunk_t* chunk = (obj_chunk_t*) data;
+    face_t* faces = chunk->faces + chunk->triangle_base;
+    const int* face_texcoords = chunk->face_texcoords + chunk->triangle_base * 3;
+    tex2_t none = { 0, 0 };
+
+    for (int f=0; f<chunk->num_faces_written; f++) {
+        const int* corners = &face_texcoords[f * 3];
+        faces[f].a_uv = corners[0] >= 0 ? chunk->texcoords[corners[0]] : none;
+        faces[f].b_uv = corners[1] >= 0 ? chunk->texcoords[corners[1]] : none;
+        faces[f].c_uv = corners[2] >= 0 ? chunk->texcoords[corners[2]] : none;
+    }
+    return 0;
+}
+
+// runs the pass on every chunk, chunk 0 on the calling thread
+void obj_run_chunks(obj_chunk_t* chunks, int num_chunks, SDL_ThreadFunction pass) {
+    SDL_Thread* threads[OBJ_MAX_CHUNKS] = { NULL };
+
+    for (int i=1; i<num_chunks; i++) {
+        threads[i] = SDL_CreateThread(pass, "obj_parse", &chunks[i]);
+        if (!threads[i]) {
+            pass(&chunks[i]);
+        }
+    }
+    pass(&chunks[0]);
+    for (int i=1; i<num_chunks; i++) {
+        if (threads[i]) {
+            SDL_WaitThread(threads[i], NULL);
+        }
+    }
+}
+
+bool obj_load(const char* filename, vec3_t** vertices, face_t** faces) {
+    *vertices = NULL;
+    *faces = NULL;
+
+    obj_file_t file;
+    if (!obj_map_file(filename, &file)) {
+        return false;
+    }
+
+    int num_chunks = 1;
+    if (file.size >= OBJ_PARALLEL_MIN_BYTES) {
+        num_chunks = SDL_GetCPUCount();
+        num_chunks = num_chunks < 1 ? 1 : num_chunks > OBJ_MAX_CHUNKS ? OBJ_MAX_CHUNKS : num_chunks;
+    }
+
+    // split into roughly equal chunks, every boundary is moved to the start of a line
+    obj_chunk_t chunks[OBJ_MAX_CHUNKS];
+    memset(chunks, 0, sizeof(chunks));
+    const char* file_end = file.data + file.size;
+    const char* chunk_begin = file.data;
+    for (int i=0; i<num_chunks; i++) {
+        const char* chunk_end = file_end;
+        if (i < num_chunks - 1) {
+            chunk_end = file.data + file.size / num_chunks * (i + 1);
+            chunk_end = chunk_end < chunk_begin ? chunk_begin : obj_skip_line(chunk_end, file_end);
+        }
+        chunks[i].begin = chunk_begin;
+        chunks[i].end = chunk_end;
+        chunk_begin = chunk_end;
+    }
+
+    obj_run_chunks(chunks, num_chunks, obj_count_chunk);
+
+    int total_vertices = 0;
+    int total_texcoords = 0;
+    int total_triangles = 0;
+    for (int i=0; i<num_chunks; i++) {
+        chunks[i].vertex_base = total_vertices;
+        chunks[i].texcoord_base = total_texcoords;
+        chunks[i].triangle_base = total_triangles;
+        total_vertices += chunks[i].num_vertices;
+        total_texcoords += chunks[i].num_texcoords;
+        total_triangles += chunks[i].num_triangles;
+    }
+
+    if (total_vertices > 0) {
+        *vertices = (vec3_t*) array_hold(NULL, total_vertices, sizeof(vec3_t));
+    }
+    if (total_triangles > 0) {
+        *faces = (face_t*) array_hold(NULL, total_triangles, sizeof(face_t));
+    }
+    // faces start out with 0, 0 everywhere, files without vt need nothing else
+    tex2_t* texcoords = NULL;
+    int* face_texcoords = NULL;
+    if (total_texcoords > 0) {
+        texcoords = (tex2_t*) malloc(sizeof(tex2_t) * total_texcoords);
+        face_texcoords = total_triangles > 0 ? (int*) malloc(sizeof(int) * 3 * total_triangles) : NULL;
+    }
+
+    for (int i=0; i<num_chunks; i++) {
+        chunks[i].total_vertices = total_vertices;
+        chunks[i].total_texcoords = total_texcoords;
+        chunks[i].vertices = *vertices;
+        chunks[i].faces = *faces;
+        chunks[i].texcoords = texcoords;
+        chunks[i].face_texcoords = face_texcoords;
+    }
+
+    obj_run_chunks(chunks, num_chunks, obj_parse_chunk);
+    if (face_texcoords) {
+        obj_run_chunks(chunks, num_chunks, obj_resolve_chunk);
+    }
+    free(texcoords);
+    free(face_texcoords);
+
+    // close the gaps left by dropped faces
+    int num_faces = 0;
+    for (int i=0; i<num_chunks; i++) {
+        if (num_faces != chunks[i].triangle_base) {
+            memmove(*faces + num_faces, *faces + chunks[i].triangle_base, sizeof(face_t) * chunks[i].num_faces_written);
+        }
+        num_faces += chunks[i].num_faces_written;
+    }
+    if (num_faces < total_triangles) {
+        fprintf(stderr, "%s: dropped %d triangles with invalid vertex indices.\n", filename, total_triangles - num_faces);
+
+        face_t* valid_faces = NULL;
+        if (num_faces > 0) {
+            valid_faces = (face_t*) array_hold(NULL, num_faces, sizeof(face_t));
+            memcpy(valid_faces, *faces, sizeof(face_t) * num_faces);
+        }
+        array_free(*faces);
+        *faces = valid_faces;
+    }
+
+    obj_unmap_file(&file);
+    return true;
+}
@@ -0,0 +1,18 @@
+#ifndef OBJ_H
+#define OBJ_H
+
+#include <stdbool.h>
+#include "vector.h"
+#include "triangle.h"
+
+// files smaller than this are parsed on the calling thread only
+#define OBJ_PARALLEL_MIN_BYTES (1 << 20)
+
+// memory-maps an .obj file and parses it in parallel chunks split on line boundaries
+// vertices and faces are returned as exactly sized dynamic arrays (see array.h)
+// faces index vertices from 0 (the file counts from 1), negative (relative) indices are resolved,
+// polygons are fanned into triangles and faces with out-of-range indices are dropped
+// the faces carry the vt coordinates of their corners, corners without a valid one get 0, 0
+bool obj_load(const char* filename, vec3_t** vertices, face_t** faces);
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "pipeline.h"
+
+SDL_Thread* pipeline_thread = NULL;
+SDL_mutex* pipeline_mutex = NULL;
+SDL_cond* pipeline_job_ready = NULL;
+SDL_cond* pipeline_job_done = NULL;
+
+// written under pipeline_mutex
+pipeline_job_t pipeline_job = NULL;
+bool pipeline_busy = false;
+bool pipeline_quit = false;
+
+int pipeline_worker(void* data) {
+    SDL_LockMutex(pipeline_mutex);
+    while (true) {
+        while (!pipeline_job && !pipeline_quit) {
+            SDL_CondWait(pipeline_job_ready, pipeline_mutex);
+        }
+        if (pipeline_quit) {
+            SDL_UnlockMutex(pipeline_mutex);
+            return 0;
+        }
+        pipeline_job_t job = pipeline_job;
+        SDL_UnlockMutex(pipeline_mutex);
+
+        job();
+
+        SDL_LockMutex(pipeline_mutex);
+        pipeline_job = NULL;
+        pipeline_busy = false;
+        SDL_CondSignal(pipeline_job_done);
+    }
+}
+
+void pipeline_start_job(pipeline_job_t job) {
+    if (!pipeline_thread) {
+        pipeline_mutex = SDL_CreateMutex();
+        pipeline_job_ready = SDL_CreateCond();
+        pipeline_job_done = SDL_CreateCond();
+        pipeline_quit = false;
+        pipeline_thread = SDL_CreateThread(pipeline_worker, "pipeline", NULL);
+    }
+
+    // a job still running would see its data change under it
+    pipeline_wait_job();
+
+    SDL_LockMutex(pipeline_mutex);
+    pipeline_job = job;
+    pipeline_busy = true;
+    SDL_CondSignal(pipeline_job_ready);
+    SDL_UnlockMutex(pipeline_mutex);
+}
+
+void pipeline_wait_job(void) {
+    if (!pipeline_thread) {
+        return;
+    }
+
+    SDL_LockMutex(pipeline_mutex);
+    while (pipeline_busy) {
+        SDL_CondWait(pipeline_job_done, pipeline_mutex);
+    }
+    SDL_UnlockMutex(pipeline_mutex);
+}
+
+void pipeline_shutdown(void) {
+    if (!pipeline_thread) {
+        return;
+    }
+
+    pipeline_wait_job();
+
+    SDL_LockMutex(pipeline_mutex);
+    pipeline_quit = true;
+    SDL_CondSignal(pipeline_job_ready);
+    SDL_UnlockMutex(pipeline_mutex);
+    SDL_WaitThread(pipeline_thread, NULL);
+
+    SDL_DestroyCond(pipeline_job_ready);
+    SDL_DestroyCond(pipeline_job_done);
+    SDL_DestroyMutex(pipeline_mutex);
+    pipeline_thread = NULL;
+}
@@ -0,0 +1,18 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+
+typedef void (*pipeline_job_t)(void);
+
+// a single background thread that runs one job at a time while the calling thread does something else,
+// the frame loop builds the next frame's triangles on it while the current frame is rasterized
+// the thread is started by the first pipeline_start_job
+void pipeline_start_job(pipeline_job_t job);
+// blocks until the last job started has finished, returns at once if none is running
+void pipeline_wait_job(void);
+
+// waits for the running job and stops the thread
+void pipeline_shutdown(void);
+
+#endif
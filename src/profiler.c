@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profiler.h"
+#include "display.h"
+#include "font.h"
+#include "background.h"
+
+bool profiler_enabled = false;
+
+// multi-producer ring: a writer claims a slot with one atomic add and publishes it through the slot's sequence,
+// readers copy a slot and keep it only if the sequence was the expected one before and after the copy
+profile_event_t profile_events[PROFILER_MAX_EVENTS];
+SDL_atomic_t profile_head;
+// first event profiler_end_frame hasn't looked at yet
+int profile_read = 0;
+
+profile_stage_t profile_stages[PROFILER_MAX_STAGES];
+int num_profile_stages = 0;
+int num_profiled_frames = 0;
+SDL_threadID profile_main_thread = 0;
+
+profile_counter_t profile_counters[PROFILER_MAX_COUNTERS];
+int num_profile_counters = 0;
+
+int profile_dropped_events = 0;
+// copies of the events of the frame being folded, so the nesting can be worked out
+profile_event_t profile_frame_events[PROFILER_MAX_FRAME_EVENTS];
+
+void profile_record(const char* name, uint64_t start, uint64_t end) {
+    int index = SDL_AtomicAdd(&profile_head, 1);
+    profile_event_t* event = &profile_events[index & (PROFILER_MAX_EVENTS - 1)];
+
+    SDL_AtomicSet(&event->sequence, 0);
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    event->thread = SDL_ThreadID();
+    SDL_AtomicSet(&event->sequence, index + 1);
+}
+
+// copies the event at ring index, false if it was overwritten or is still being written
+bool profile_read_event(int index, profile_event_t* out) {
+    profile_event_t* event = &profile_events[index & (PROFILER_MAX_EVENTS - 1)];
+    if (SDL_AtomicGet(&event->sequence) != index + 1) {
+        return false;
+    }
+    out->name = event->name;
+    out->start = event->start;
+    out->end = event->end;
+    out->thread = event->thread;
+    return SDL_AtomicGet(&event->sequence) == index + 1;
+}
+
+double profile_ticks_to_ms(uint64_t ticks) {
+    return (double) ticks * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+profile_stage_t* profile_find_stage(const char* name) {
+    for (int s=0; s<num_profile_stages; s++) {
+        if (profile_stages[s].name == name) {
+            return &profile_stages[s];
+        }
+    }
+    if (num_profile_stages == PROFILER_MAX_STAGES) {
+        return NULL;
+    }
+    profile_stage_t* stage = &profile_stages[num_profile_stages++];
+    memset(stage, 0, sizeof(*stage));
+    stage->name = name;
+    stage->first_start = UINT64_MAX;
+    return stage;
+}
+
+void profile_count(const char* name, double value) {
+    if (!profiler_enabled) {
+        return;
+    }
+
+    for (int c=0; c<num_profile_counters; c++) {
+        if (profile_counters[c].name == name) {
+            profile_counters[c].frame_value += value;
+            return;
+        }
+    }
+    if (num_profile_counters == PROFILER_MAX_COUNTERS) {
+        return;
+    }
+    profile_counter_t* counter = &profile_counters[num_profile_counters++];
+    memset(counter, 0, sizeof(*counter));
+    counter->name = name;
+    counter->frame_value = value;
+}
+
+int profile_stage_compare(const void* a, const void* b) {
+    const profile_stage_t* sa = (const profile_stage_t*) a;
+    const profile_stage_t* sb = (const profile_stage_t*) b;
+    return sa->first_start < sb->first_start ? -1 : sa->first_start > sb->first_start;
+}
+
+void profiler_end_frame(void) {
+    profile_main_thread = SDL_ThreadID();
+
+    int head = SDL_AtomicGet(&profile_head);
+    if (head - profile_read > PROFILER_MAX_EVENTS) {
+        profile_dropped_events += head - PROFILER_MAX_EVENTS - profile_read;
+        profile_read = head - PROFILER_MAX_EVENTS;
+    }
+
+    // a frame is a few dozen events, or a few per tile with --tiled
+    profile_event_t* frame_events = profile_frame_events;
+    int num_frame_events = 0;
+    for (; profile_read < head; profile_read++) {
+        if (num_frame_events == PROFILER_MAX_FRAME_EVENTS) {
+            profile_dropped_events++;
+        } else if (profile_read_event(profile_read, &frame_events[num_frame_events])) {
+            num_frame_events++;
+        }
+    }
+    if (num_frame_events == 0) {
+        return;
+    }
+
+    for (int s=0; s<num_profile_stages; s++) {
+        profile_stages[s].frame_ms = 0;
+        profile_stages[s].first_start = UINT64_MAX;
+        profile_stages[s].depth = 0;
+    }
+
+    for (int i=0; i<num_frame_events; i++) {
+        const profile_event_t* event = &frame_events[i];
+        profile_stage_t* stage = profile_find_stage(event->name);
+        if (!stage) {
+            continue;
+        }
+
+        // enclosed by a longer event of the same thread
+        int depth = 0;
+        for (int j=0; j<num_frame_events; j++) {
+            const profile_event_t* other = &frame_events[j];
+            if (other->thread == event->thread && other->start <= event->start && other->end >= event->end &&
+                other->end - other->start > event->end - event->start) {
+                depth++;
+            }
+        }
+
+        stage->depth = depth > stage->depth ? depth : stage->depth;
+        stage->frame_ms += profile_ticks_to_ms(event->end - event->start);
+        stage->first_start = event->start < stage->first_start ? event->start : stage->first_start;
+    }
+
+    for (int s=0; s<num_profile_stages; s++) {
+        profile_stage_t* stage = &profile_stages[s];
+        stage->average_ms = num_profiled_frames == 0 ? stage->frame_ms :
+            stage->average_ms + (stage->frame_ms - stage->average_ms) * PROFILER_SMOOTHING;
+        stage->total_ms += stage->frame_ms;
+    }
+    for (int c=0; c<num_profile_counters; c++) {
+        profile_counter_t* counter = &profile_counters[c];
+        counter->average = num_profiled_frames == 0 ? counter->frame_value :
+            counter->average + (counter->frame_value - counter->average) * PROFILER_SMOOTHING;
+        counter->total += counter->frame_value;
+        counter->frame_value = 0;
+    }
+    num_profiled_frames++;
+
+    // stages missing from this frame keep their place at the end
+    qsort(profile_stages, num_profile_stages, sizeof(profile_stage_t), profile_stage_compare);
+}
+
+void profiler_reset_stages(void) {
+    num_profile_stages = 0;
+    num_profile_counters = 0;
+    num_profiled_frames = 0;
+    profile_dropped_events = 0;
+    profile_read = SDL_AtomicGet(&profile_head);
+}
+
+void profiler_draw_overlay(void) {
+    int scale = window_height >= 720 ? 2 : 1;
+    int line_height = (FONT_GLYPH_HEIGHT + 3) * scale;
+    int margin = 4 * scale;
+    int name_columns = 14;
+    // name, a space, "%7.2f" and " MS"
+    int text_columns = name_columns + 11;
+    int bar_width = 60 * scale;
+    int width = margin * 3 + text_columns * FONT_ADVANCE * scale + bar_width;
+    int num_lines = num_profile_stages + num_profile_counters + (profile_dropped_events > 0 ? 1 : 0);
+    int height = margin * 2 + line_height * num_lines;
+
+    dirty_mark_rect(0, 0, width, height);
+
+    // darken what is behind the text instead of hiding it
+    for (int y=0; y<height && y<window_height; y++) {
+        for (int x=0; x<width && x<window_width; x++) {
+            uint32_t* pixel = &color_buffer[y * color_buffer_pitch + x];
+            *pixel = 0xFF000000 | ((*pixel >> 2) & 0x003F3F3F);
+        }
+    }
+
+    // bars are relative to the slowest stage, which is the whole frame when it is profiled
+    double longest_ms = 0;
+    for (int s=0; s<num_profile_stages; s++) {
+        longest_ms = profile_stages[s].average_ms > longest_ms ? profile_stages[s].average_ms : longest_ms;
+    }
+
+    for (int s=0; s<num_profile_stages; s++) {
+        const profile_stage_t* stage = &profile_stages[s];
+        int y = margin + s * line_height;
+        char line[64];
+        snprintf(line, sizeof(line), "%*s%-*.*s %7.2f MS", stage->depth, "", name_columns - stage->depth, name_columns - stage->depth, stage->name, stage->average_ms);
+        draw_text(margin, y, line, 0xFFFFFFFF, scale);
+
+        int bar_x = margin * 2 + text_columns * FONT_ADVANCE * scale;
+        int bar_length = longest_ms > 0 ? (int) (bar_width * stage->average_ms / longest_ms) : 0;
+        for (int by=y; by<y + FONT_GLYPH_HEIGHT * scale && by<window_height; by++) {
+            for (int bx=bar_x; bx<bar_x + bar_length && bx<window_width; bx++) {
+                color_buffer[by * color_buffer_pitch + bx] = 0xFF40C040;
+            }
+        }
+    }
+
+    for (int c=0; c<num_profile_counters; c++) {
+        const profile_counter_t* counter = &profile_counters[c];
+        char line[64];
+        snprintf(line, sizeof(line), "%-*.*s %10.0f", name_columns, name_columns, counter->name, counter->average);
+        draw_text(margin, margin + (num_profile_stages + c) * line_height, line, 0xFFFFFFFF, scale);
+    }
+
+    // the stage times above are missing these, so they read low
+    if (profile_dropped_events > 0) {
+        char line[64];
+        snprintf(line, sizeof(line), "%-*.*s %10d", name_columns, name_columns, "DROPPED EVENTS", profile_dropped_events);
+        draw_text(margin, margin + (num_profile_stages + num_profile_counters) * line_height, line, 0xFFFF6060, scale);
+    }
+}
+
+void profiler_print_summary(void) {
+    for (int s=0; s<num_profile_stages; s++) {
+        const profile_stage_t* stage = &profile_stages[s];
+        printf("  %*s%-*s %10.3f ms/frame\n", stage->depth * 2, "", 20 - stage->depth * 2, stage->name,
+            num_profiled_frames > 0 ? stage->total_ms / num_profiled_frames : 0);
+    }
+    for (int c=0; c<num_profile_counters; c++) {
+        const profile_counter_t* counter = &profile_counters[c];
+        printf("  %-20s %10.0f per frame\n", counter->name,
+            num_profiled_frames > 0 ? counter->total / num_profiled_frames : 0);
+    }
+    if (profile_dropped_events > 0) {
+        printf("  %d events were dropped, the stage times above are too low\n", profile_dropped_events);
+    }
+}
+
+bool profiler_write_trace(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error opening %s.\n", filename);
+        return false;
+    }
+
+    int head = SDL_AtomicGet(&profile_head);
+    int first = head > PROFILER_MAX_EVENTS ? head - PROFILER_MAX_EVENTS : 0;
+
+    uint64_t epoch = UINT64_MAX;
+    profile_event_t event;
+    for (int i=first; i<head; i++) {
+        if (profile_read_event(i, &event) && event.start < epoch) {
+            epoch = event.start;
+        }
+    }
+
+    // chrome wants small thread ids, the main thread is 0 and the others are numbered as they turn up
+    SDL_threadID threads[64] = { profile_main_thread };
+    int num_threads = 1;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}}");
+    for (int i=first; i<head; i++) {
+        if (!profile_read_event(i, &event)) {
+            continue;
+        }
+
+        int tid = 0;
+        while (tid < num_threads && threads[tid] != event.thread) {
+            tid++;
+        }
+        if (tid == num_threads && num_threads < 64) {
+            threads[num_threads++] = event.thread;
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}", tid, tid);
+        }
+
+        // complete events, timestamps in microseconds
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            event.name, tid,
+            profile_ticks_to_ms(event.start - epoch) * 1000.0,
+            profile_ticks_to_ms(event.end - event.start) * 1000.0);
+    }
+    fprintf(file, "\n]}\n");
+
+    fclose(file);
+    return true;
+}
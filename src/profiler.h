@@ -0,0 +1,82 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+// events the ring holds, a power of two; the oldest are overwritten, so a trace covers the last few seconds
+#define PROFILER_MAX_EVENTS (1 << 16)
+// distinct stage names the overlay and the summary keep numbers for
+#define PROFILER_MAX_STAGES 32
+// distinct counter names
+#define PROFILER_MAX_COUNTERS 8
+// events profiler_end_frame folds into the stages per frame, the rest are counted as dropped
+#define PROFILER_MAX_FRAME_EVENTS 1024
+// weight of the newest frame in the overlay's running averages
+#define PROFILER_SMOOTHING 0.05
+
+// one timed scope, written by whichever thread ran it
+typedef struct {
+    SDL_atomic_t sequence;  // ring index + 1 once the slot is completely written, 0 while it is being written
+    const char* name;       // a string literal, its address identifies the stage
+    uint64_t start;         // SDL_GetPerformanceCounter ticks
+    uint64_t end;
+    SDL_threadID thread;
+} profile_event_t;
+
+// a stage's numbers, per frame it summed all of its events
+typedef struct {
+    const char* name;
+    int depth;              // how many other stages on the same thread enclose it
+    uint64_t first_start;   // start of its first event in the last frame, orders the overlay
+    double frame_ms;
+    double average_ms;
+    double total_ms;        // since the last profiler_reset_stages
+} profile_stage_t;
+
+// a per-frame quantity other than time, summed over the frame
+typedef struct {
+    const char* name;       // a string literal, like the stage names
+    double frame_value;
+    double average;
+    double total;           // since the last profiler_reset_stages
+} profile_counter_t;
+
+// checked by every scope, while false they cost one branch
+extern bool profiler_enabled;
+// events left out of the stage numbers since the last profiler_reset_stages, because the frame had more than
+// PROFILER_MAX_FRAME_EVENTS or the ring wrapped before they were read; the overlay and summary show it when not 0
+extern int profile_dropped_events;
+
+// adds one event to the ring, safe to call from any thread without locking
+void profile_record(const char* name, uint64_t start, uint64_t end);
+
+// start of a scope, 0 when the profiler is off
+static inline uint64_t profile_begin(void) {
+    return profiler_enabled ? SDL_GetPerformanceCounter() : 0;
+}
+
+// end of a scope started by profile_begin, nothing is recorded if the profiler was off at its start
+static inline void profile_end(const char* name, uint64_t start) {
+    if (start) {
+        profile_record(name, start, SDL_GetPerformanceCounter());
+    }
+}
+
+// adds value to this frame's count, main thread only
+void profile_count(const char* name, double value);
+
+// folds the events recorded since the last call into the stage numbers, once per frame on the main thread
+void profiler_end_frame(void);
+void profiler_reset_stages(void);
+
+// draws the stage and counter averages into color_buffer at the top left corner
+void profiler_draw_overlay(void);
+// prints the mean time per frame of every stage and the mean of every counter since the last reset
+void profiler_print_summary(void);
+
+// writes every event still in the ring as Chrome trace-event JSON (chrome://tracing, Perfetto)
+bool profiler_write_trace(const char* filename);
+
+#endif
@@ -0,0 +1,520 @@
+#include <stdint.h>
+#include <math.h>
+#include "rasterizer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// E(x, y) = a*x + b*y + c over subpixel coordinates, positive on the inside
+// c already carries the fill rule bias, so a pixel is covered when E >= 0 for all three edges
+typedef struct {
+    int64_t a;
+    int64_t b;
+    int64_t c;
+} edge_t;
+
+void edge_setup(edge_t* edge, int x0, int y0, int x1, int y1) {
+    edge->a = (int64_t) y0 - y1;
+    edge->b = (int64_t) x1 - x0;
+    edge->c = (int64_t) x0 * y1 - (int64_t) y0 * x1;
+
+    // top-left rule: pixels exactly on a top or left edge belong to this triangle,
+    // pixels exactly on the other edges belong to the neighbour sharing that edge
+    bool top_left = edge->a > 0 || (edge->a == 0 && edge->b > 0);
+    if (!top_left) {
+        edge->c -= 1;
+    }
+}
+
+// rounds half away from zero, without the libm call lrintf would be
+int to_subpixel(float v) {
+    return (int) (v * SUBPIXEL_SCALE + (v >= 0 ? 0.5f : -0.5f));
+}
+
+int subpixel_floor(int v) {
+    return v >= 0 ? v >> SUBPIXEL_BITS : -((-v + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS);
+}
+
+// writes one pixel, after an early depth test when a depth plane is given
+static inline void raster_pixel(int x, int y, uint32_t color, const depth_plane_t* depth) {
+    if (depth) {
+        int index = window_width * y + x;
+        float inv_w = depth->a * (x + 0.5f) + depth->b * (y + 0.5f) + depth->c;
+        if (!(inv_w > z_buffer[index])) {
+            return;
+        }
+        z_buffer[index] = inv_w;
+    }
+    color_buffer[color_buffer_pitch * y + x] = color;
+}
+
+// writes the fully covered pixels [x_start, x_end) of row y
+static inline void raster_span(int x_start, int x_end, int y, uint32_t color, const depth_plane_t* depth) {
+    uint32_t* color_row = color_buffer + color_buffer_pitch * y;
+
+    if (depth == NULL) {
+        int x = x_start;
+#if defined(__SSE2__)
+        __m128i colors = _mm_set1_epi32((int) color);
+        for (; x + 4 <= x_end; x += 4) {
+            _mm_storeu_si128((__m128i*) (color_row + x), colors);
+        }
+#endif
+        for (; x < x_end; x++) {
+            color_row[x] = color;
+        }
+        return;
+    }
+
+    float* depth_row = z_buffer + window_width * y;
+    float row_w = depth->b * (y + 0.5f);
+    int x = x_start;
+#if defined(__SSE2__)
+    // 4 pixels at a time, in the operation order of raster_pixel so both agree bit for bit
+    __m128 a = _mm_set1_ps(depth->a);
+    __m128 row = _mm_set1_ps(row_w);
+    __m128 c = _mm_set1_ps(depth->c);
+    __m128 colors = _mm_castsi128_ps(_mm_set1_epi32((int) color));
+    __m128 xs = _mm_add_ps(_mm_set1_ps((float) x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+    for (; x + 4 <= x_end; x += 4) {
+        __m128 inv_w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, xs), row), c);
+        __m128 old_depth = _mm_loadu_ps(depth_row + x);
+        __m128 closer = _mm_cmpgt_ps(inv_w, old_depth);
+        xs = _mm_add_ps(xs, _mm_set1_ps(4.0f));
+        if (_mm_movemask_ps(closer) == 0) {
+            continue;
+        }
+        _mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(closer, inv_w), _mm_andnot_ps(closer, old_depth)));
+        __m128 old_color = _mm_loadu_ps((float*) (color_row + x));
+        _mm_storeu_ps((float*) (color_row + x), _mm_or_ps(_mm_and_ps(closer, colors), _mm_andnot_ps(closer, old_color)));
+    }
+#endif
+    for (; x < x_end; x++) {
+        float inv_w = depth->a * (x + 0.5f) + row_w + depth->c;
+        if (inv_w > depth_row[x]) {
+            depth_row[x] = inv_w;
+            color_row[x] = color;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+// writes the 4 pixels starting at (x, y) selected by mask, depth tested when a depth plane is given
+static inline void raster_row4(int x, int y, __m128i mask, uint32_t color, const depth_plane_t* depth) {
+    uint32_t* color_row = color_buffer + color_buffer_pitch * y + x;
+
+    if (depth) {
+        // same operation order as raster_pixel so both paths agree bit for bit
+        __m128 xs = _mm_add_ps(_mm_set1_ps((float) x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+        __m128 inv_w = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(depth->a), xs),
+                _mm_mul_ps(_mm_set1_ps(depth->b), _mm_set1_ps(y + 0.5f))
+            ),
+            _mm_set1_ps(depth->c)
+        );
+        float* depth_row = z_buffer + window_width * y + x;
+        __m128 old_depth = _mm_loadu_ps(depth_row);
+        mask = _mm_and_si128(mask, _mm_castps_si128(_mm_cmpgt_ps(inv_w, old_depth)));
+        __m128 new_depth = _mm_or_ps(
+            _mm_and_ps(_mm_castsi128_ps(mask), inv_w),
+            _mm_andnot_ps(_mm_castsi128_ps(mask), old_depth)
+        );
+        _mm_storeu_ps(depth_row, new_depth);
+    }
+
+    __m128i old_color = _mm_loadu_si128((__m128i*) color_row);
+    __m128i new_color = _mm_or_si128(
+        _mm_and_si128(mask, _mm_set1_epi32((int) color)),
+        _mm_andnot_si128(mask, old_color)
+    );
+    _mm_storeu_si128((__m128i*) color_row, new_color);
+}
+#endif
+
+// tests every pixel of a block that some edges cross, e holds the edge values at its top-left pixel
+static inline void raster_partial_block(int bx, int by, int block_w, int block_h, const int32_t* e, const int32_t* step_x, const int32_t* step_y, uint32_t color, const depth_plane_t* depth, const clip_rect_t* clip) {
+#if defined(__SSE2__)
+    // an edge that doesn't cross the block passes every pixel of it, so all three are tested alike
+    __m128i values[3];
+    __m128i row_step[3];
+    for (int k=0; k<3; k++) {
+        int sx = step_x[k];
+        values[k] = _mm_add_epi32(_mm_set1_epi32(e[k]), _mm_set_epi32(3 * sx, 2 * sx, sx, 0));
+        row_step[k] = _mm_set1_epi32(step_y[k]);
+    }
+
+    // lanes past the right end of a narrow block are never covered, and its rows are
+    // only read and written 4 pixels at a time while those stay inside clip
+    __m128i lanes = _mm_cmpgt_epi32(_mm_set1_epi32(block_w), _mm_set_epi32(3, 2, 1, 0));
+    bool whole_rows = bx + RASTER_BLOCK_SIZE <= clip->max_x;
+
+    for (int j=0; j<block_h; j++) {
+        __m128i mask = lanes;
+        for (int k=0; k<3; k++) {
+            mask = _mm_and_si128(mask, _mm_cmpgt_epi32(values[k], _mm_set1_epi32(-1)));
+            values[k] = _mm_add_epi32(values[k], row_step[k]);
+        }
+        int covered = _mm_movemask_ps(_mm_castsi128_ps(mask));
+        if (covered == 0) {
+            continue;
+        }
+        if (whole_rows) {
+            raster_row4(bx, by + j, mask, color, depth);
+        } else {
+            for (int i=0; i<block_w; i++) {
+                if (covered & (1 << i)) {
+                    raster_pixel(bx + i, by + j, color, depth);
+                }
+            }
+        }
+    }
+#else
+    for (int j=0; j<block_h; j++) {
+        int y = by + j;
+        for (int i=0; i<block_w; i++) {
+            bool covered = true;
+            for (int k=0; k<3; k++) {
+                covered = covered && e[k] + step_x[k] * i + step_y[k] * j >= 0;
+            }
+            if (covered) {
+                raster_pixel(bx + i, y, color, depth);
+            }
+        }
+    }
+#endif
+}
+
+// the edge functions of a triangle in pixel steps, from the center of the top-left pixel of its box
+typedef struct {
+    int64_t origin[3];
+    int64_t step_x[3];
+    int64_t step_y[3];
+    int min_x;
+    int min_y;
+} raster_edges_t;
+
+// rasterizes the pixels [min_x, max_x] x [min_y, max_y] of the triangle's box in 4x4 blocks,
+// the chunk being at most RASTER_CHUNK_SIZE pixels on a side
+void raster_chunk(const raster_edges_t* edges, int min_x, int min_y, int max_x, int max_y, uint32_t color, const depth_plane_t* depth, const clip_rect_t* clip) {
+    int32_t row_start[3], step_x[3], step_y[3], corner_min[3], corner_max[3];
+
+    for (int k=0; k<3; k++) {
+        int64_t value = edges->origin[k] + edges->step_x[k] * (min_x - edges->min_x) + edges->step_y[k] * (min_y - edges->min_y);
+        int64_t across = edges->step_x[k] * (max_x - min_x);
+        int64_t down = edges->step_y[k] * (max_y - min_y);
+        int64_t smallest = value + (across < 0 ? across : 0) + (down < 0 ? down : 0);
+        int64_t largest = value + (across > 0 ? across : 0) + (down > 0 ? down : 0);
+
+        if (largest < 0) {
+            // the whole chunk is outside this edge
+            return;
+        }
+        if (smallest >= 0) {
+            // the whole chunk is inside this edge, which a constant 0 stands in for
+            row_start[k] = step_x[k] = step_y[k] = 0;
+        } else {
+            // the edge crosses the chunk: pixel steps are below 2^22 inside the guard band,
+            // so its values over the chunk and a block around it fit in 32 bits
+            row_start[k] = (int32_t) value;
+            step_x[k] = (int32_t) edges->step_x[k];
+            step_y[k] = (int32_t) edges->step_y[k];
+        }
+
+        // offsets from a block's top-left pixel to the corners where the edge function is smallest and largest
+        int32_t block_x = step_x[k] * (RASTER_BLOCK_SIZE - 1);
+        int32_t block_y = step_y[k] * (RASTER_BLOCK_SIZE - 1);
+        corner_min[k] = (block_x < 0 ? block_x : 0) + (block_y < 0 ? block_y : 0);
+        corner_max[k] = (block_x > 0 ? block_x : 0) + (block_y > 0 ? block_y : 0);
+    }
+
+    for (int by = min_y; by <= max_y; by += RASTER_BLOCK_SIZE) {
+        int block_h = max_y - by + 1 < RASTER_BLOCK_SIZE ? max_y - by + 1 : RASTER_BLOCK_SIZE;
+        int32_t e[3] = { row_start[0], row_start[1], row_start[2] };
+        int bx = min_x;
+
+        while (bx <= max_x) {
+            int block_w = max_x - bx + 1 < RASTER_BLOCK_SIZE ? max_x - bx + 1 : RASTER_BLOCK_SIZE;
+            bool fully_inside = true;
+            bool row_done = false;
+            int32_t skip = 0;
+
+            // the edge functions are linear, so their extremes over the block are at the corners
+            for (int k=0; k<3; k++) {
+                int32_t largest = e[k] + corner_max[k];
+
+                if (largest < 0 && step_x[k] > 0) {
+                    // left of this edge: jump straight to the first block that can reach it
+                    int32_t block_step = step_x[k] * RASTER_BLOCK_SIZE;
+                    int32_t blocks = (-largest + block_step - 1) / block_step;
+                    skip = blocks > skip ? blocks : skip;
+                } else if (largest < 0) {
+                    // right of this edge: the rest of the row is outside too
+                    row_done = true;
+                }
+
+                fully_inside = fully_inside && e[k] + corner_min[k] >= 0;
+            }
+
+            if (row_done || (skip > 0 && skip > (max_x - bx) / RASTER_BLOCK_SIZE)) {
+                break;
+            }
+
+            int run = 1;
+
+            if (skip > 0) {
+                run = skip;
+            } else if (fully_inside) {
+                // trivially accepted: extend over the following accepted blocks and fill them as spans
+                while (bx + (run + 1) * RASTER_BLOCK_SIZE - 1 <= max_x) {
+                    bool accepted = true;
+                    for (int k=0; k<3; k++) {
+                        accepted = accepted && e[k] + step_x[k] * RASTER_BLOCK_SIZE * run + corner_min[k] >= 0;
+                    }
+                    if (!accepted) {
+                        break;
+                    }
+                    run++;
+                }
+
+                int span_end = run == 1 ? bx + block_w : bx + run * RASTER_BLOCK_SIZE;
+                for (int j=0; j<block_h; j++) {
+                    raster_span(bx, span_end, by + j, color, depth);
+                }
+            } else {
+                // partially covered block: test the edges that cross it per pixel
+                raster_partial_block(bx, by, block_w, block_h, e, step_x, step_y, color, depth, clip);
+            }
+
+            bx += run * RASTER_BLOCK_SIZE;
+            for (int k=0; k<3; k++) {
+                e[k] += step_x[k] * RASTER_BLOCK_SIZE * run;
+            }
+        }
+
+        for (int k=0; k<3; k++) {
+            row_start[k] += step_y[k] * RASTER_BLOCK_SIZE;
+        }
+    }
+}
+
+bool draw_filled_triangle_halfspace(const triangle_t* triangle, bool depth_test, const clip_rect_t* clip) {
+    for (int i=0; i<3; i++) {
+        // written so that NaN coordinates fail the test as well
+        if (!(fabsf(triangle->points[i].x) < RASTER_GUARD_BAND && fabsf(triangle->points[i].y) < RASTER_GUARD_BAND)) {
+            return false;
+        }
+    }
+
+    // snap to the subpixel grid
+    int x0 = to_subpixel(triangle->points[0].x);
+    int y0 = to_subpixel(triangle->points[0].y);
+    int x1 = to_subpixel(triangle->points[1].x);
+    int y1 = to_subpixel(triangle->points[1].y);
+    int x2 = to_subpixel(triangle->points[2].x);
+    int y2 = to_subpixel(triangle->points[2].y);
+
+    int64_t area = (int64_t) (x1 - x0) * (y2 - y0) - (int64_t) (x2 - x0) * (y1 - y0);
+    if (area == 0) {
+        return true;
+    }
+
+    // both windings are filled, so flip the counter-clockwise ones
+    if (area < 0) {
+        int t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+    }
+
+    edge_t edges[3];
+    edge_setup(&edges[0], x0, y0, x1, y1);
+    edge_setup(&edges[1], x1, y1, x2, y2);
+    edge_setup(&edges[2], x2, y2, x0, y0);
+
+    // bounding box in pixels, clipped to the viewport once here
+    int min_x = subpixel_floor(x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2));
+    int min_y = subpixel_floor(y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2));
+    int max_x = subpixel_floor(x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2));
+    int max_y = subpixel_floor(y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2));
+
+    if (min_x < clip->min_x) min_x = clip->min_x;
+    if (min_y < clip->min_y) min_y = clip->min_y;
+    if (max_x > clip->max_x - 1) max_x = clip->max_x - 1;
+    if (max_y > clip->max_y - 1) max_y = clip->max_y - 1;
+
+    if (min_x > max_x || min_y > max_y) {
+        return true;
+    }
+
+    depth_plane_t plane;
+    const depth_plane_t* depth = NULL;
+    if (depth_test) {
+        if (!triangle_depth_plane(triangle, &plane)) {
+            return true;
+        }
+        depth = &plane;
+    }
+
+    raster_edges_t raster_edges = { .min_x = min_x, .min_y = min_y };
+    for (int k=0; k<3; k++) {
+        int64_t px = ((int64_t) min_x << SUBPIXEL_BITS) + SUBPIXEL_SCALE / 2;
+        int64_t py = ((int64_t) min_y << SUBPIXEL_BITS) + SUBPIXEL_SCALE / 2;
+        raster_edges.origin[k] = edges[k].a * px + edges[k].b * py + edges[k].c;
+        raster_edges.step_x[k] = edges[k].a * SUBPIXEL_SCALE;
+        raster_edges.step_y[k] = edges[k].b * SUBPIXEL_SCALE;
+    }
+
+    for (int cy = min_y; cy <= max_y; cy += RASTER_CHUNK_SIZE) {
+        int chunk_max_y = cy + RASTER_CHUNK_SIZE - 1 < max_y ? cy + RASTER_CHUNK_SIZE - 1 : max_y;
+        for (int cx = min_x; cx <= max_x; cx += RASTER_CHUNK_SIZE) {
+            int chunk_max_x = cx + RASTER_CHUNK_SIZE - 1 < max_x ? cx + RASTER_CHUNK_SIZE - 1 : max_x;
+            raster_chunk(&raster_edges, cx, cy, chunk_max_x, chunk_max_y, triangle->color, depth, clip);
+        }
+    }
+
+    return true;
+}
+
+// u/w, v/w and 1/w over the screen, and the size of level 0 to turn uv steps into texels
+typedef struct {
+    depth_plane_t inv_w;
+    depth_plane_t u;
+    depth_plane_t v;
+    float width;
+    float height;
+} texture_planes_t;
+
+// mip level for the footprint of the pixel at x, y: d(u/w / 1/w)/dx = (u/w' - u * 1/w') * w
+int texture_span_level(const texture_t* texture, const texture_planes_t* planes, float x, float y) {
+    float q = planes->inv_w.a * x + planes->inv_w.b * y + planes->inv_w.c;
+    float w = 1.0f / q;
+    float u = (planes->u.a * x + planes->u.b * y + planes->u.c) * w;
+    float v = (planes->v.a * x + planes->v.b * y + planes->v.c) * w;
+
+    float du_dx = (planes->u.a - u * planes->inv_w.a) * w * planes->width;
+    float dv_dx = (planes->v.a - v * planes->inv_w.a) * w * planes->height;
+    float du_dy = (planes->u.b - u * planes->inv_w.b) * w * planes->width;
+    float dv_dy = (planes->v.b - v * planes->inv_w.b) * w * planes->height;
+    float along_x = du_dx * du_dx + dv_dx * dv_dx;
+    float along_y = du_dy * du_dy + dv_dy * dv_dy;
+    return texture_level_for(texture, along_x > along_y ? along_x : along_y);
+}
+
+// textures the pixels [x_start, x_end] of row y from one mip level
+void texture_span(int x_start, int x_end, int y, const texture_t* texture, int level, const texture_planes_t* planes, bool depth_test) {
+    uint32_t* color_row = color_buffer + color_buffer_pitch * y;
+    float* depth_row = z_buffer + window_width * y;
+    float row_y = y + 0.5f;
+
+    // 1/w in the same operation order as raster_pixel, so the depth buffer agrees with the flat fills
+    float row_w = planes->inv_w.b * row_y;
+    float row_u = planes->u.b * row_y + planes->u.c;
+    float row_v = planes->v.b * row_y + planes->v.c;
+    for (int x = x_start; x <= x_end; x++) {
+        float px = x + 0.5f;
+        float inv_w = planes->inv_w.a * px + row_w + planes->inv_w.c;
+        if (depth_test) {
+            if (!(inv_w > depth_row[x])) {
+                continue;
+            }
+            depth_row[x] = inv_w;
+        }
+        float w = 1.0f / inv_w;
+        color_row[x] = texture_sample(texture, level, (planes->u.a * px + row_u) * w, (planes->v.a * px + row_v) * w);
+    }
+}
+
+bool draw_textured_triangle(const triangle_t* triangle, const texture_t* texture, bool depth_test, const clip_rect_t* clip) {
+    for (int i=0; i<3; i++) {
+        if (!(fabsf(triangle->points[i].x) < RASTER_GUARD_BAND && fabsf(triangle->points[i].y) < RASTER_GUARD_BAND)) {
+            return false;
+        }
+    }
+
+    int x0 = to_subpixel(triangle->points[0].x);
+    int y0 = to_subpixel(triangle->points[0].y);
+    int x1 = to_subpixel(triangle->points[1].x);
+    int y1 = to_subpixel(triangle->points[1].y);
+    int x2 = to_subpixel(triangle->points[2].x);
+    int y2 = to_subpixel(triangle->points[2].y);
+
+    int64_t area = (int64_t) (x1 - x0) * (y2 - y0) - (int64_t) (x2 - x0) * (y1 - y0);
+    if (area == 0) {
+        return true;
+    }
+    if (area < 0) {
+        int t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+    }
+
+    edge_t edges[3];
+    edge_setup(&edges[0], x0, y0, x1, y1);
+    edge_setup(&edges[1], x1, y1, x2, y2);
+    edge_setup(&edges[2], x2, y2, x0, y0);
+
+    // the spans are found within the unclipped box, so their mip levels don't depend on clip
+    int triangle_min_x = subpixel_floor(x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2));
+    int triangle_max_x = subpixel_floor(x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2));
+    int min_x = triangle_min_x;
+    int min_y = subpixel_floor(y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2));
+    int max_x = triangle_max_x;
+    int max_y = subpixel_floor(y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2));
+
+    if (min_x < clip->min_x) min_x = clip->min_x;
+    if (min_y < clip->min_y) min_y = clip->min_y;
+    if (max_x > clip->max_x - 1) max_x = clip->max_x - 1;
+    if (max_y > clip->max_y - 1) max_y = clip->max_y - 1;
+
+    if (min_x > max_x || min_y > max_y || texture->num_levels == 0) {
+        return true;
+    }
+
+    // the attribute planes come from the unsnapped corners, whichever way they wind
+    texture_planes_t planes;
+    float u_over_w[3], v_over_w[3];
+    for (int i=0; i<3; i++) {
+        u_over_w[i] = triangle->texcoords[i].u * triangle->inv_w[i];
+        v_over_w[i] = triangle->texcoords[i].v * triangle->inv_w[i];
+    }
+    if (!triangle_depth_plane(triangle, &planes.inv_w) ||
+        !triangle_attribute_plane(triangle, u_over_w, &planes.u) ||
+        !triangle_attribute_plane(triangle, v_over_w, &planes.v)) {
+        return true;
+    }
+    planes.width = texture->levels[0].width;
+    planes.height = texture->levels[0].height;
+
+    // E(x) = a * (x * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2) + b * py + c along a row is linear in x,
+    // so the covered pixels, E >= 0 for every edge, are one span whose ends come from a division per edge
+    for (int y = min_y; y <= max_y; y++) {
+        int64_t py = ((int64_t) y << SUBPIXEL_BITS) + SUBPIXEL_SCALE / 2;
+        int64_t span_start = triangle_min_x;
+        int64_t span_end = triangle_max_x;
+
+        for (int k=0; k<3; k++) {
+            int64_t step = edges[k].a * SUBPIXEL_SCALE;
+            int64_t at_zero = edges[k].a * (SUBPIXEL_SCALE / 2) + edges[k].b * py + edges[k].c;
+            if (step > 0) {
+                int64_t first = ceil_div(-at_zero, step);
+                span_start = first > span_start ? first : span_start;
+            } else if (step < 0) {
+                int64_t last = floor_div(at_zero, -step);
+                span_end = last < span_end ? last : span_end;
+            } else if (at_zero < 0) {
+                span_end = span_start - 1;
+            }
+        }
+
+        if (span_start > span_end) {
+            continue;
+        }
+        int level = texture_span_level(texture, &planes, (span_start + span_end) / 2 + 0.5f, y + 0.5f);
+        span_start = span_start > min_x ? span_start : min_x;
+        span_end = span_end < max_x ? span_end : max_x;
+        if (span_start <= span_end) {
+            texture_span((int) span_start, (int) span_end, y, texture, level, &planes, depth_test);
+        }
+    }
+
+    return true;
+}
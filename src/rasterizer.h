@@ -0,0 +1,33 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include <stdbool.h>
+#include "display.h"
+#include "triangle.h"
+
+// vertices are snapped to 1/16th of a pixel
+#define SUBPIXEL_BITS 4
+#define SUBPIXEL_SCALE (1 << SUBPIXEL_BITS)
+
+// coverage is tested in square blocks of this many pixels
+#define RASTER_BLOCK_SIZE 4
+
+// the box of a triangle is walked in square chunks of this many pixels, which edge functions are 32-bit within
+#define RASTER_CHUNK_SIZE 128
+
+// triangles reaching further than this many pixels from the origin are left to the scanline filler
+#define RASTER_GUARD_BAND 8192
+
+// fills the triangle with incremental half-space edge functions and the top-left fill rule
+// pixels are sampled at their centers, blocks fully inside the triangle are filled without
+// per-pixel edge tests and partially covered blocks are tested with simd when available
+// returns false without drawing anything if the triangle is outside the guard band
+bool draw_filled_triangle_halfspace(const triangle_t* triangle, bool depth_test, const clip_rect_t* clip);
+
+// fills the same pixels as draw_filled_triangle_halfspace with the texture, one row span at a time
+// u/w, v/w and 1/w are interpolated over the screen and divided per pixel, so the mapping is perspective correct;
+// each span samples the mip level the footprint of its middle pixel asks for, whatever part of it clip leaves
+// returns false without drawing anything if the triangle is outside the guard band
+bool draw_textured_triangle(const triangle_t* triangle, const texture_t* texture, bool depth_test, const clip_rect_t* clip);
+
+#endif
@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <string.h>
+#include "scene.h"
+#include "array.h"
+
+int scene_add_mesh(scene_t* scene) {
+    mesh_t empty = { 0 };
+    dynarray_push(&scene->meshes, empty);
+    return (int) scene->meshes.length - 1;
+}
+
+int scene_add_cube_mesh(scene_t* scene) {
+    int index = scene_add_mesh(scene);
+    load_cube_mesh_data(&scene->meshes.items[index]);
+    build_mesh_meshlets(&scene->meshes.items[index]);
+    return index;
+}
+
+int scene_add_obj_mesh(scene_t* scene, char* filename) {
+    int index = scene_add_mesh(scene);
+    load_obj_file_data(&scene->meshes.items[index], filename);
+    return index;
+}
+
+int scene_add_grid_mesh(scene_t* scene, int columns, int rows) {
+    int index = scene_add_mesh(scene);
+    load_grid_mesh_data(&scene->meshes.items[index], columns, rows);
+    build_mesh_meshlets(&scene->meshes.items[index]);
+    return index;
+}
+
+int scene_add_instance(scene_t* scene, int mesh) {
+    instance_t instance = {
+        .mesh = mesh,
+        .rotation = {0, 0, 0},
+        .previous_rotation = {0, 0, 0},
+        .scale = {1.0, 1.0, 1.0},
+        .translation = {0, 0, 0},
+        .color = INSTANCE_MESH_COLOR
+    };
+    dynarray_push(&scene->instances, instance);
+    scene->bvh_dirty = true;
+    return (int) scene->instances.length - 1;
+}
+
+void scene_update_world_matrices(scene_t* scene, float alpha) {
+    size_t num_instances = scene->instances.length;
+    dynarray_reserve(&scene->world_matrices, num_instances);
+    dynarray_reserve(&scene->face_offsets, num_instances);
+    dynarray_reserve(&scene->instance_bounds, num_instances);
+    dynarray_reserve(&scene->instance_spheres, num_instances);
+    scene->world_matrices.length = num_instances;
+    scene->face_offsets.length = num_instances;
+    scene->instance_bounds.length = num_instances;
+    scene->instance_spheres.length = num_instances;
+
+    int num_faces = 0;
+    for (size_t i=0; i<num_instances; i++) {
+        const instance_t* instance = &scene->instances.items[i];
+
+        // stepping back from the current rotation keeps alpha = 1 exact
+        vec3_t rotation = vec3_add(instance->rotation, vec3_mul(vec3_sub(instance->previous_rotation, instance->rotation), 1 - alpha));
+
+        // scale, rotate around x, y and z, then translate
+        mat4_t world_matrix = mat4_make_world(instance->scale, rotation, instance->translation);
+        scene->world_matrices.items[i] = world_matrix;
+
+        const mesh_t* mesh = &scene->meshes.items[instance->mesh];
+        scene->instance_bounds.items[i] = aabb_transform(mesh->bounds, &world_matrix);
+        scene->instance_spheres.items[i] = bounding_sphere_transform(mesh->sphere, &world_matrix);
+
+        scene->face_offsets.items[i] = num_faces;
+        num_faces += array_length(mesh->faces);
+    }
+    scene->num_faces = num_faces;
+
+    int max_vertices = 0;
+    for (size_t m=0; m<scene->meshes.length; m++) {
+        int num_vertices = scene->meshes.items[m].positions.count;
+        max_vertices = num_vertices > max_vertices ? num_vertices : max_vertices;
+    }
+    scene->max_vertices = max_vertices;
+}
+
+int index_compare_function(const void* a, const void* b) {
+    return *(const int*) a - *(const int*) b;
+}
+
+void scene_cull(scene_t* scene, const frustum_t* frustum) {
+    int num_instances = (int) scene->instances.length;
+    dynarray_clear(&scene->visible_instances);
+    dynarray_reserve(&scene->visible_instances, (size_t) num_instances);
+
+    if (!frustum) {
+        for (int i=0; i<num_instances; i++) {
+            scene->visible_instances.items[i] = i;
+        }
+        scene->visible_instances.length = num_instances;
+    } else {
+        if (scene->bvh_dirty) {
+            bvh_build(&scene->bvh, scene->instance_bounds.items, num_instances);
+            scene->bvh_dirty = false;
+        } else {
+            bvh_refit(&scene->bvh, scene->instance_bounds.items);
+        }
+
+        bvh_cull(&scene->bvh, frustum, scene->instance_bounds.items, scene->instance_spheres.items, &scene->visible_instances);
+        // back in instance order, so what gets drawn doesn't depend on the tree layout
+        qsort(scene->visible_instances.items, scene->visible_instances.length, sizeof(int), index_compare_function);
+    }
+
+    size_t num_visible = scene->visible_instances.length;
+    dynarray_reserve(&scene->visible_lods, (size_t) num_instances);
+    memset(scene->visible_lods.items, 0, sizeof(int) * num_visible);
+    scene->visible_lods.length = num_visible;
+
+    int num_visible_faces = 0;
+    for (size_t v=0; v<num_visible; v++) {
+        const instance_t* instance = &scene->instances.items[scene->visible_instances.items[v]];
+        num_visible_faces += array_length(scene->meshes.items[instance->mesh].faces);
+    }
+    scene->num_visible_faces = num_visible_faces;
+}
+
+void scene_select_lods(scene_t* scene, float pixels_per_unit, float max_pixel_error) {
+    int num_visible_faces = 0;
+    for (size_t v=0; v<scene->visible_instances.length; v++) {
+        int k = scene->visible_instances.items[v];
+        const mesh_t* mesh = &scene->meshes.items[scene->instances.items[k].mesh];
+        bounding_sphere_t sphere = scene->instance_spheres.items[k];
+
+        // the camera is at the origin, nothing of the instance is closer than this
+        float distance = vec3_length(sphere.center) - sphere.radius;
+        int level = 0;
+        if (distance > 0) {
+            float scale = mesh->sphere.radius > 0 ? sphere.radius / mesh->sphere.radius : 1;
+            float pixels_per_model_unit = scale * pixels_per_unit / distance;
+            while (level < mesh->num_lods && mesh->lods[level].error * pixels_per_model_unit <= max_pixel_error) {
+                level++;
+            }
+        }
+
+        scene->visible_lods.items[v] = level;
+        num_visible_faces += array_length((void*) mesh_level_faces(mesh, level));
+    }
+    scene->num_visible_faces = num_visible_faces;
+}
+
+void scene_free(scene_t* scene) {
+    for (size_t m=0; m<scene->meshes.length; m++) {
+        free_mesh_data(&scene->meshes.items[m]);
+    }
+    dynarray_free(&scene->meshes);
+    dynarray_free(&scene->instances);
+    dynarray_free(&scene->world_matrices);
+    dynarray_free(&scene->face_offsets);
+    dynarray_free(&scene->instance_bounds);
+    dynarray_free(&scene->instance_spheres);
+    dynarray_free(&scene->visible_instances);
+    dynarray_free(&scene->visible_lods);
+    bvh_free(&scene->bvh);
+    scene->bvh_dirty = false;
+    scene->num_faces = 0;
+    scene->num_visible_faces = 0;
+    scene->max_vertices = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdint.h>
+#include "vector.h"
+#include "matrix.h"
+#include "mesh.h"
+#include "dynarray.h"
+#include "bounds.h"
+#include "bvh.h"
+
+// instance color that keeps the colors of the mesh faces
+#define INSTANCE_MESH_COLOR 0
+
+// one placed copy of a scene mesh, it only owns its transform and color
+typedef struct {
+    int mesh;           // index into the scene meshes
+    vec3_t rotation;    // euler angles
+    vec3_t previous_rotation;   // before the last simulation step, frames in between interpolate
+    vec3_t scale;
+    vec3_t translation;
+    uint32_t color;     // drawn instead of the face colors, unless INSTANCE_MESH_COLOR
+} instance_t;
+
+// meshes are loaded once and shared, any number of instances can point at the same one
+typedef struct {
+    DYNARRAY(mesh_t) meshes;
+    DYNARRAY(instance_t) instances;
+    DYNARRAY(mat4_t) world_matrices;    // per instance, rebuilt by scene_update_world_matrices
+    DYNARRAY(int) face_offsets;         // first scene wide face id of each instance
+    DYNARRAY(aabb_t) instance_bounds;   // world space, per instance, rebuilt with the world matrices
+    DYNARRAY(bounding_sphere_t) instance_spheres;
+    bvh_t bvh;                          // over instance_bounds
+    bool bvh_dirty;                     // instances were added since the last build
+    bvh_index_list_t visible_instances; // output of scene_cull, in instance order
+    DYNARRAY(int) visible_lods;         // mesh level each visible instance is drawn with
+    int num_faces;                      // faces over all instances
+    int num_visible_faces;              // faces over the visible instances, at their levels
+    int max_vertices;                   // vertex count of the largest mesh
+} scene_t;
+
+// all return the index of the new mesh, split into meshlets, the obj one also gets levels of detail
+int scene_add_cube_mesh(scene_t* scene);
+int scene_add_obj_mesh(scene_t* scene, char* filename);
+int scene_add_grid_mesh(scene_t* scene, int columns, int rows);
+
+// returns the index of the new instance, placed at the origin with the mesh colors
+int scene_add_instance(scene_t* scene, int mesh);
+
+// world matrix and world bounds of every instance in one pass, and the face numbering the depth sort follows
+// the rotation is taken alpha of the way from previous_rotation to rotation, 1 uses rotation as it is
+void scene_update_world_matrices(scene_t* scene, float alpha);
+
+// fills visible_instances with the instances that may be inside the frustum, or all of them without one
+// the bvh is refit to this frame's bounds, and only rebuilt after instances were added
+// every visible instance starts out at the full detail level
+void scene_cull(scene_t* scene, const frustum_t* frustum);
+
+// gives every visible instance the coarsest level whose error, projected from the nearest point
+// of its bounding sphere, stays within max_pixel_error pixels
+// pixels_per_unit is how many pixels a unit long feature covers at distance 1
+void scene_select_lods(scene_t* scene, float pixels_per_unit, float max_pixel_error);
+
+void scene_free(scene_t* scene);
+
+#endif
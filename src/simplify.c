@@ -0,0 +1,501 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "simplify.h"
+#include "array.h"
+#include "dynarray.h"
+
+// symmetric 4x4 matrix, upper triangle: a2 ab ac ad b2 bc bd c2 cd d2
+typedef struct {
+    double q[10];
+} quadric_t;
+
+typedef struct {
+    double cost;
+    int u;
+    int v;
+    int version_u;      // the edge is stale once either vertex changed after it was pushed
+    int version_v;
+    vec3_t target;
+} collapse_t;
+
+typedef struct {
+    int a;
+    int b;
+} edge_t;
+
+typedef struct {
+    int num_vertices;
+    int num_faces;
+    int live_faces;
+    double max_cost;
+
+    vec3_t* positions;
+    quadric_t* quadrics;
+    int* versions;
+    bool* removed;
+    int* mark;          // neighbor dedupe, holds the collapse number the vertex was last seen in
+    int num_collapses;
+
+    int* corners;       // 3 per face, rewritten as vertices collapse
+    uint32_t* colors;
+    tex2_t* texcoords;  // 3 per face, a corner keeps its texture coordinates wherever its vertex moves
+    bool* face_alive;
+
+    // per vertex singly linked list of the faces using it, lists are concatenated on collapse
+    int* head;
+    int* tail;
+    int* node_face;
+    int* node_next;
+
+    DYNARRAY(collapse_t) heap;
+} simplifier_t;
+
+void quadric_add_plane(quadric_t* quadric, double a, double b, double c, double d, double weight) {
+    double plane[4] = { a, b, c, d };
+    int k = 0;
+    for (int i=0; i<4; i++) {
+        for (int j=i; j<4; j++) {
+            quadric->q[k++] += weight * plane[i] * plane[j];
+        }
+    }
+}
+
+void quadric_add(quadric_t* a, const quadric_t* b) {
+    for (int i=0; i<10; i++) {
+        a->q[i] += b->q[i];
+    }
+}
+
+// sum of the squared (weighted) distances of p to every plane in the quadric
+double quadric_error(const quadric_t* quadric, vec3_t p) {
+    const double* q = quadric->q;
+    double x = p.x;
+    double y = p.y;
+    double z = p.z;
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+        + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+        + q[7] * z * z + 2 * q[8] * z
+        + q[9];
+}
+
+// the point minimizing the error, false when the planes don't pin one down
+bool quadric_optimum(const quadric_t* quadric, vec3_t* p) {
+    const double* q = quadric->q;
+    double a00 = q[0], a01 = q[1], a02 = q[2];
+    double a11 = q[4], a12 = q[5];
+    double a22 = q[7];
+    double b0 = -q[3], b1 = -q[6], b2 = -q[8];
+
+    double c00 = a11 * a22 - a12 * a12;
+    double c01 = a02 * a12 - a01 * a22;
+    double c02 = a01 * a12 - a02 * a11;
+    double determinant = a00 * c00 + a01 * c01 + a02 * c02;
+
+    // relative to the matrix scale, so tiny and huge models behave the same
+    double scale = fabs(a00) + fabs(a11) + fabs(a22);
+    if (fabs(determinant) <= 1e-9 * scale * scale * scale) {
+        return false;
+    }
+
+    double c11 = a00 * a22 - a02 * a02;
+    double c12 = a01 * a02 - a00 * a12;
+    double c22 = a00 * a11 - a01 * a01;
+
+    p->x = (c00 * b0 + c01 * b1 + c02 * b2) / determinant;
+    p->y = (c01 * b0 + c11 * b1 + c12 * b2) / determinant;
+    p->z = (c02 * b0 + c12 * b1 + c22 * b2) / determinant;
+    return true;
+}
+
+void heap_push(simplifier_t* s, collapse_t collapse) {
+    dynarray_push(&s->heap, collapse);
+    collapse_t* items = s->heap.items;
+    size_t i = s->heap.length - 1;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (items[parent].cost <= items[i].cost) {
+            break;
+        }
+        collapse_t swap = items[parent];
+        items[parent] = items[i];
+        items[i] = swap;
+        i = parent;
+    }
+}
+
+collapse_t heap_pop(simplifier_t* s) {
+    collapse_t* items = s->heap.items;
+    collapse_t top = items[0];
+    items[0] = items[--s->heap.length];
+
+    size_t count = s->heap.length;
+    size_t i = 0;
+    while (true) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < count && items[left].cost < items[smallest].cost) smallest = left;
+        if (right < count && items[right].cost < items[smallest].cost) smallest = right;
+        if (smallest == i) {
+            break;
+        }
+        collapse_t swap = items[smallest];
+        items[smallest] = items[i];
+        items[i] = swap;
+        i = smallest;
+    }
+    return top;
+}
+
+void push_edge(simplifier_t* s, int u, int v) {
+    quadric_t quadric = s->quadrics[u];
+    quadric_add(&quadric, &s->quadrics[v]);
+
+    vec3_t target;
+    double cost;
+    if (quadric_optimum(&quadric, &target)) {
+        cost = quadric_error(&quadric, target);
+    } else {
+        // no single optimum (flat or straight regions), take the best of the ends and the middle
+        vec3_t candidates[3] = {
+            s->positions[u],
+            s->positions[v],
+            vec3_mul(vec3_add(s->positions[u], s->positions[v]), 0.5)
+        };
+        target = candidates[0];
+        cost = quadric_error(&quadric, candidates[0]);
+        for (int i=1; i<3; i++) {
+            double candidate_cost = quadric_error(&quadric, candidates[i]);
+            if (candidate_cost < cost) {
+                cost = candidate_cost;
+                target = candidates[i];
+            }
+        }
+    }
+
+    collapse_t collapse = {
+        .cost = cost > 0 ? cost : 0,
+        .u = u,
+        .v = v,
+        .version_u = s->versions[u],
+        .version_v = s->versions[v],
+        .target = target
+    };
+    heap_push(s, collapse);
+}
+
+vec3_t face_normal(vec3_t a, vec3_t b, vec3_t c) {
+    return vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+}
+
+// moving vertex to target must not fold any face that survives the collapse
+bool collapse_keeps_orientation(const simplifier_t* s, int vertex, int other, vec3_t target) {
+    for (int n=s->head[vertex]; n != -1; n=s->node_next[n]) {
+        int f = s->node_face[n];
+        if (!s->face_alive[f]) {
+            continue;
+        }
+        const int* corners = &s->corners[f * 3];
+        if (corners[0] == other || corners[1] == other || corners[2] == other) {
+            continue;   // collapses with the edge
+        }
+
+        vec3_t p[3];
+        vec3_t moved[3];
+        for (int j=0; j<3; j++) {
+            p[j] = s->positions[corners[j]];
+            moved[j] = corners[j] == vertex ? target : p[j];
+        }
+
+        vec3_t before = face_normal(p[0], p[1], p[2]);
+        vec3_t after = face_normal(moved[0], moved[1], moved[2]);
+        float before_length = vec3_length(before);
+        float after_length = vec3_length(after);
+        if (before_length <= 0) {
+            continue;   // already degenerate, nothing to fold
+        }
+        if (after_length <= 0) {
+            return false;
+        }
+        if (vec3_dot(before, after) < SIMPLIFY_MIN_NORMAL_DOT * before_length * after_length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool try_collapse(simplifier_t* s, const collapse_t* collapse) {
+    int u = collapse->u;
+    int v = collapse->v;
+
+    if (!collapse_keeps_orientation(s, u, v, collapse->target) || !collapse_keeps_orientation(s, v, u, collapse->target)) {
+        return false;
+    }
+
+    s->positions[u] = collapse->target;
+    quadric_add(&s->quadrics[u], &s->quadrics[v]);
+    s->removed[v] = true;
+    s->versions[u]++;
+    if (collapse->cost > s->max_cost) {
+        s->max_cost = collapse->cost;
+    }
+
+    // faces on the edge disappear, the others around v now use u
+    for (int n=s->head[v]; n != -1; n=s->node_next[n]) {
+        int f = s->node_face[n];
+        if (!s->face_alive[f]) {
+            continue;
+        }
+        int* corners = &s->corners[f * 3];
+        if (corners[0] == u || corners[1] == u || corners[2] == u) {
+            s->face_alive[f] = false;
+            s->live_faces--;
+            continue;
+        }
+        for (int j=0; j<3; j++) {
+            if (corners[j] == v) {
+                corners[j] = u;
+            }
+        }
+    }
+
+    if (s->head[v] != -1) {
+        if (s->head[u] == -1) {
+            s->head[u] = s->head[v];
+        } else {
+            s->node_next[s->tail[u]] = s->head[v];
+        }
+        s->tail[u] = s->tail[v];
+        s->head[v] = -1;
+    }
+
+    // every edge around u changed cost
+    s->num_collapses++;
+    s->mark[u] = s->num_collapses;
+    for (int n=s->head[u]; n != -1; n=s->node_next[n]) {
+        int f = s->node_face[n];
+        if (!s->face_alive[f]) {
+            continue;
+        }
+        for (int j=0; j<3; j++) {
+            int w = s->corners[f * 3 + j];
+            if (s->mark[w] != s->num_collapses) {
+                s->mark[w] = s->num_collapses;
+                push_edge(s, u, w);
+            }
+        }
+    }
+    return true;
+}
+
+int edge_compare_function(const void* a, const void* b) {
+    const edge_t* e1 = (const edge_t*) a;
+    const edge_t* e2 = (const edge_t*) b;
+    if (e1->a != e2->a) {
+        return e1->a < e2->a ? -1 : 1;
+    }
+    return (e1->b > e2->b) - (e1->b < e2->b);
+}
+
+void simplifier_init(simplifier_t* s, const vec3_t* vertices, const face_t* faces) {
+    memset(s, 0, sizeof(simplifier_t));
+    int nv = array_length((void*) vertices);
+    int nf = array_length((void*) faces);
+    s->num_vertices = nv;
+    s->num_faces = nf;
+
+    s->positions = (vec3_t*) malloc(sizeof(vec3_t) * (nv > 0 ? nv : 1));
+    if (nv > 0) {
+        memcpy(s->positions, vertices, sizeof(vec3_t) * nv);
+    }
+    s->quadrics = (quadric_t*) calloc(nv > 0 ? nv : 1, sizeof(quadric_t));
+    s->versions = (int*) calloc(nv > 0 ? nv : 1, sizeof(int));
+    s->removed = (bool*) calloc(nv > 0 ? nv : 1, sizeof(bool));
+    s->mark = (int*) calloc(nv > 0 ? nv : 1, sizeof(int));
+    s->head = (int*) malloc(sizeof(int) * (nv > 0 ? nv : 1));
+    s->tail = (int*) malloc(sizeof(int) * (nv > 0 ? nv : 1));
+    for (int i=0; i<nv; i++) {
+        s->head[i] = -1;
+        s->tail[i] = -1;
+    }
+
+    s->corners = (int*) malloc(sizeof(int) * 3 * (nf > 0 ? nf : 1));
+    s->colors = (uint32_t*) malloc(sizeof(uint32_t) * (nf > 0 ? nf : 1));
+    s->texcoords = (tex2_t*) malloc(sizeof(tex2_t) * 3 * (nf > 0 ? nf : 1));
+    s->face_alive = (bool*) calloc(nf > 0 ? nf : 1, sizeof(bool));
+    s->node_face = (int*) malloc(sizeof(int) * 3 * (nf > 0 ? nf : 1));
+    s->node_next = (int*) malloc(sizeof(int) * 3 * (nf > 0 ? nf : 1));
+
+    edge_t* edges = (edge_t*) malloc(sizeof(edge_t) * 3 * (nf > 0 ? nf : 1));
+    int num_edges = 0;
+    int num_nodes = 0;
+
+    for (int f=0; f<nf; f++) {
+        int corners[3] = { faces[f].a, faces[f].b, faces[f].c };
+        s->colors[f] = faces[f].color;
+        s->texcoords[f * 3] = faces[f].a_uv;
+        s->texcoords[f * 3 + 1] = faces[f].b_uv;
+        s->texcoords[f * 3 + 2] = faces[f].c_uv;
+        memcpy(&s->corners[f * 3], corners, sizeof(corners));
+
+        bool valid = true;
+        for (int j=0; j<3; j++) {
+            valid = valid && corners[j] >= 0 && corners[j] < nv;
+        }
+        valid = valid && corners[0] != corners[1] && corners[1] != corners[2] && corners[0] != corners[2];
+        if (!valid) {
+            continue;
+        }
+        s->face_alive[f] = true;
+        s->live_faces++;
+
+        vec3_t a = vertices[corners[0]];
+        vec3_t b = vertices[corners[1]];
+        vec3_t c = vertices[corners[2]];
+        vec3_t normal = face_normal(a, b, c);
+        float length = vec3_length(normal);
+        if (length > 0) {
+            // unweighted, so the error stays a sum of squared distances and its root bounds how far the surface moved
+            vec3_t n = vec3_div(normal, length);
+            double d = -vec3_dot(n, a);
+            for (int j=0; j<3; j++) {
+                quadric_add_plane(&s->quadrics[corners[j]], n.x, n.y, n.z, d, 1.0);
+            }
+        }
+
+        for (int j=0; j<3; j++) {
+            int vertex = corners[j];
+            s->node_face[num_nodes] = f;
+            s->node_next[num_nodes] = -1;
+            if (s->head[vertex] == -1) {
+                s->head[vertex] = num_nodes;
+            } else {
+                s->node_next[s->tail[vertex]] = num_nodes;
+            }
+            s->tail[vertex] = num_nodes;
+            num_nodes++;
+
+            int other = corners[(j + 1) % 3];
+            edges[num_edges].a = vertex < other ? vertex : other;
+            edges[num_edges].b = vertex < other ? other : vertex;
+            num_edges++;
+        }
+    }
+
+    qsort(edges, num_edges, sizeof(edge_t), edge_compare_function);
+
+    // edges used by a single face are borders, a plane through them at right angles to the face keeps them in place
+    for (int i=0; i<num_edges;) {
+        int run = 1;
+        while (i + run < num_edges && edges[i + run].a == edges[i].a && edges[i + run].b == edges[i].b) {
+            run++;
+        }
+
+        int a = edges[i].a;
+        int b = edges[i].b;
+        if (run == 1) {
+            // the face it belongs to gives the orientation
+            for (int n=s->head[a]; n != -1; n=s->node_next[n]) {
+                const int* corners = &s->corners[s->node_face[n] * 3];
+                if (corners[0] != b && corners[1] != b && corners[2] != b) {
+                    continue;
+                }
+                vec3_t normal = face_normal(vertices[corners[0]], vertices[corners[1]], vertices[corners[2]]);
+                vec3_t edge = vec3_sub(vertices[b], vertices[a]);
+                vec3_t border = vec3_cross(edge, normal);
+                float length = vec3_length(border);
+                if (length > 0) {
+                    vec3_t n = vec3_div(border, length);
+                    double d = -vec3_dot(n, vertices[a]);
+                    quadric_add_plane(&s->quadrics[a], n.x, n.y, n.z, d, SIMPLIFY_BORDER_WEIGHT);
+                    quadric_add_plane(&s->quadrics[b], n.x, n.y, n.z, d, SIMPLIFY_BORDER_WEIGHT);
+                }
+                break;
+            }
+        }
+
+        push_edge(s, a, b);
+        i += run;
+    }
+
+    free(edges);
+}
+
+void simplifier_free(simplifier_t* s) {
+    free(s->positions);
+    free(s->quadrics);
+    free(s->versions);
+    free(s->removed);
+    free(s->mark);
+    free(s->head);
+    free(s->tail);
+    free(s->corners);
+    free(s->colors);
+    free(s->texcoords);
+    free(s->face_alive);
+    free(s->node_face);
+    free(s->node_next);
+    dynarray_free(&s->heap);
+}
+
+// the live faces and the vertices they use, renumbered
+void simplifier_extract(const simplifier_t* s, simplified_mesh_t* level) {
+    int* remap = (int*) malloc(sizeof(int) * (s->num_vertices > 0 ? s->num_vertices : 1));
+    for (int i=0; i<s->num_vertices; i++) {
+        remap[i] = -1;
+    }
+
+    level->vertices = NULL;
+    level->faces = NULL;
+    int num_vertices = 0;
+    for (int f=0; f<s->num_faces; f++) {
+        if (!s->face_alive[f]) {
+            continue;
+        }
+        int corners[3];
+        for (int j=0; j<3; j++) {
+            int vertex = s->corners[f * 3 + j];
+            if (remap[vertex] == -1) {
+                remap[vertex] = num_vertices++;
+                array_push(level->vertices, s->positions[vertex]);
+            }
+            corners[j] = remap[vertex];
+        }
+        face_t face = {
+            .a = corners[0], .b = corners[1], .c = corners[2],
+            .a_uv = s->texcoords[f * 3], .b_uv = s->texcoords[f * 3 + 1], .c_uv = s->texcoords[f * 3 + 2],
+            .color = s->colors[f]
+        };
+        array_push(level->faces, face);
+    }
+    level->error = (float) sqrt(s->max_cost);
+
+    free(remap);
+}
+
+int simplify_mesh(const vec3_t* vertices, const face_t* faces, const int* target_faces, int num_targets, simplified_mesh_t* levels) {
+    simplifier_t s;
+    simplifier_init(&s, vertices, faces);
+
+    int num_levels = 0;
+    for (int t=0; t<num_targets; t++) {
+        while (s.live_faces > target_faces[t] && s.heap.length > 0) {
+            collapse_t collapse = heap_pop(&s);
+            bool stale = s.removed[collapse.u] || s.removed[collapse.v] ||
+                s.versions[collapse.u] != collapse.version_u ||
+                s.versions[collapse.v] != collapse.version_v;
+            if (!stale) {
+                try_collapse(&s, &collapse);
+            }
+        }
+
+        if (s.live_faces > target_faces[t]) {
+            break;  // no legal collapse left
+        }
+        simplifier_extract(&s, &levels[num_levels++]);
+    }
+
+    simplifier_free(&s);
+    return num_levels;
+}
@@ -0,0 +1,25 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "vector.h"
+#include "triangle.h"
+
+// faces whose normal would turn by more than this (as a cosine) reject the collapse
+#define SIMPLIFY_MIN_NORMAL_DOT 0.2
+// open edges are held in place by a plane through them, this much stiffer than a face plane
+#define SIMPLIFY_BORDER_WEIGHT 10.0
+
+// one simplified copy of a mesh
+typedef struct {
+    vec3_t* vertices;   // array.h arrays, faces are 0-based like the loaded ones
+    face_t* faces;
+    float error;        // largest distance (in model units) any collapse so far has moved the surface by
+} simplified_mesh_t;
+
+// quadric error edge collapse (Garland and Heckbert), a single run from the full mesh down,
+// taking a copy every time the face count reaches the next target, so every level's error
+// is measured against the original surface
+// target_faces must be descending, returns how many levels were reached (the mesh can run out of legal collapses)
+int simplify_mesh(const vec3_t* vertices, const face_t* faces, const int* target_faces, int num_targets, simplified_mesh_t* levels);
+
+#endif
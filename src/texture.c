@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "texture.h"
+
+int texture_next_power_of_two(int n) {
+    int p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+int texture_log2(int power_of_two) {
+    int shift = 0;
+    while ((1 << shift) < power_of_two) {
+        shift++;
+    }
+    return shift;
+}
+
+// texels a level takes in the layout, the tiled one rounds both sides up to whole tiles
+int texture_level_size(int width, int height, texture_layout_t layout) {
+    if (layout == TEXTURE_LINEAR) {
+        return width * height;
+    }
+    int tiles_x = (width + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+    int tiles_y = (height + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+    return tiles_x * tiles_y * TEXTURE_TILE_SIZE * TEXTURE_TILE_SIZE;
+}
+
+// average of up to four argb texels, channel by channel
+uint32_t texture_average(const uint32_t* texels, int count) {
+    uint32_t sums[4] = { 0, 0, 0, 0 };
+    for (int i=0; i<count; i++) {
+        for (int c=0; c<4; c++) {
+            sums[c] += (texels[i] >> (c * 8)) & 0xFF;
+        }
+    }
+    uint32_t result = 0;
+    for (int c=0; c<4; c++) {
+        result |= ((sums[c] + count / 2) / count) << (c * 8);
+    }
+    return result;
+}
+
+// lays out the levels for the texture's size and layout and allocates their texels
+void texture_allocate(texture_t* texture, int width, int height, texture_layout_t layout) {
+    memset(texture, 0, sizeof(texture_t));
+    texture->layout = layout;
+
+    int total = 0;
+    for (;;) {
+        texture_level_t* level = &texture->levels[texture->num_levels++];
+        level->width = width;
+        level->height = height;
+        level->width_mask = width - 1;
+        level->height_mask = height - 1;
+        int tiles_per_row = (width + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+        level->row_shift = texture_log2(layout == TEXTURE_LINEAR ? width : tiles_per_row << (2 * TEXTURE_TILE_BITS));
+        total += texture_level_size(width, height, layout);
+
+        if ((width == 1 && height == 1) || texture->num_levels == TEXTURE_MAX_LEVELS) {
+            break;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+
+    // padding texels of partial tiles stay 0
+    texture->texels = (uint32_t*) calloc(total, sizeof(uint32_t));
+    int offset = 0;
+    for (int i=0; i<texture->num_levels; i++) {
+        texture->levels[i].texels = texture->texels + offset;
+        offset += texture_level_size(texture->levels[i].width, texture->levels[i].height, layout);
+    }
+}
+
+// stores a level given row by row in the texture's layout
+void texture_store_level(texture_t* texture, int index, const uint32_t* rows) {
+    texture_level_t* level = &texture->levels[index];
+    for (int y=0; y<level->height; y++) {
+        for (int x=0; x<level->width; x++) {
+            level->texels[texture_texel_index(level, texture->layout, x, y)] = rows[y * level->width + x];
+        }
+    }
+}
+
+void texture_from_pixels(texture_t* texture, const uint32_t* pixels, int width, int height, texture_layout_t layout) {
+    int level_width = texture_next_power_of_two(width);
+    int level_height = texture_next_power_of_two(height);
+    texture_allocate(texture, level_width, level_height, layout);
+
+    // nearest resampling up to the power of two sides, a no-op copy when they already are
+    uint32_t* rows = (uint32_t*) malloc(sizeof(uint32_t) * level_width * level_height);
+    for (int y=0; y<level_height; y++) {
+        int source_y = (int) ((long long) y * height / level_height);
+        for (int x=0; x<level_width; x++) {
+            int source_x = (int) ((long long) x * width / level_width);
+            rows[y * level_width + x] = pixels[source_y * width + source_x];
+        }
+    }
+    uint32_t* half_rows = (uint32_t*) malloc(sizeof(uint32_t) * level_width * level_height);
+
+    for (int i=0; i<texture->num_levels; i++) {
+        texture_store_level(texture, i, rows);
+        if (i + 1 == texture->num_levels) {
+            break;
+        }
+
+        // a side that is already 1 is only halved along the other one
+        const texture_level_t* level = &texture->levels[i];
+        const texture_level_t* next = &texture->levels[i + 1];
+        int step_x = level->width > 1 ? 2 : 1;
+        int step_y = level->height > 1 ? 2 : 1;
+        for (int y=0; y<next->height; y++) {
+            for (int x=0; x<next->width; x++) {
+                uint32_t block[4];
+                int count = 0;
+                for (int dy=0; dy<step_y; dy++) {
+                    for (int dx=0; dx<step_x; dx++) {
+                        block[count++] = rows[(y * step_y + dy) * level->width + x * step_x + dx];
+                    }
+                }
+                half_rows[y * next->width + x] = texture_average(block, count);
+            }
+        }
+
+        uint32_t* swap = rows;
+        rows = half_rows;
+        half_rows = swap;
+    }
+
+    free(rows);
+    free(half_rows);
+}
+
+void texture_make_checker(texture_t* texture, int size, int square_size, texture_layout_t layout) {
+    uint32_t* pixels = (uint32_t*) malloc(sizeof(uint32_t) * size * size);
+    for (int y=0; y<size; y++) {
+        for (int x=0; x<size; x++) {
+            bool dark = ((x / square_size) + (y / square_size)) % 2;
+            // a gradient across the squares, so a wrong texel is visible and not just the other square color
+            uint32_t shade = (uint32_t) (x * 255 / size);
+            pixels[y * size + x] = dark ? 0xFF202060 | (shade << 8) : 0xFFE0E0E0 - (shade << 16) / 2;
+        }
+    }
+    texture_from_pixels(texture, pixels, size, size, layout);
+    free(pixels);
+}
+
+// skips whitespace and # comments between the header fields
+int texture_ppm_next(FILE* file) {
+    int c = fgetc(file);
+    while (c == '#' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = fgetc(file);
+            }
+        }
+        c = fgetc(file);
+    }
+    return c;
+}
+
+bool texture_ppm_read_int(FILE* file, int* out) {
+    int c = texture_ppm_next(file);
+    if (c < '0' || c > '9') {
+        return false;
+    }
+    long long value = 0;
+    while (c >= '0' && c <= '9') {
+        value = value < (1 << 24) ? value * 10 + (c - '0') : value;
+        c = fgetc(file);
+    }
+    // the single whitespace byte after the last field is consumed here
+    *out = (int) value;
+    return true;
+}
+
+bool texture_load_ppm(texture_t* texture, const char* filename, texture_layout_t layout) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error opening %s.\n", filename);
+        return false;
+    }
+
+    int width, height, max_value;
+    bool valid = fgetc(file) == 'P' && fgetc(file) == '6' &&
+        texture_ppm_read_int(file, &width) && texture_ppm_read_int(file, &height) && texture_ppm_read_int(file, &max_value) &&
+        width > 0 && height > 0 && width <= (1 << 14) && height <= (1 << 14) && max_value == 255;
+    if (!valid) {
+        fprintf(stderr, "%s is not an 8 bit binary ppm.\n", filename);
+        fclose(file);
+        return false;
+    }
+
+    uint8_t* rgb = (uint8_t*) malloc((size_t) width * height * 3);
+    bool complete = fread(rgb, 3, (size_t) width * height, file) == (size_t) width * height;
+    fclose(file);
+    if (!complete) {
+        fprintf(stderr, "%s is truncated.\n", filename);
+        free(rgb);
+        return false;
+    }
+
+    uint32_t* pixels = (uint32_t*) malloc(sizeof(uint32_t) * width * height);
+    for (int i=0; i<width * height; i++) {
+        pixels[i] = 0xFF000000 | (rgb[i * 3] << 16) | (rgb[i * 3 + 1] << 8) | rgb[i * 3 + 2];
+    }
+    free(rgb);
+
+    texture_free(texture);
+    texture_from_pixels(texture, pixels, width, height, layout);
+    free(pixels);
+    return true;
+}
+
+void texture_set_layout(texture_t* texture, texture_layout_t layout) {
+    if (layout == texture->layout || texture->num_levels == 0) {
+        return;
+    }
+
+    const texture_level_t* base = &texture->levels[0];
+    texture_t converted;
+    texture_allocate(&converted, base->width, base->height, layout);
+
+    uint32_t* rows = (uint32_t*) malloc(sizeof(uint32_t) * base->width * base->height);
+    for (int i=0; i<texture->num_levels; i++) {
+        const texture_level_t* level = &texture->levels[i];
+        for (int y=0; y<level->height; y++) {
+            for (int x=0; x<level->width; x++) {
+                rows[y * level->width + x] = level->texels[texture_texel_index(level, texture->layout, x, y)];
+            }
+        }
+        texture_store_level(&converted, i, rows);
+    }
+    free(rows);
+
+    texture_free(texture);
+    *texture = converted;
+}
+
+void texture_free(texture_t* texture) {
+    free(texture->texels);
+    memset(texture, 0, sizeof(texture_t));
+}
@@ -0,0 +1,96 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+// enough levels for a 32768 texel side
+#define TEXTURE_MAX_LEVELS 16
+// the tiled layout stores square tiles of 1 << TEXTURE_TILE_BITS texels per side, 32 x 32 argb texels are a 4 KB page,
+// and the morton order inside a tile keeps every aligned 4 x 4 block in one 64 byte cache line
+#define TEXTURE_TILE_BITS 5
+#define TEXTURE_TILE_SIZE (1 << TEXTURE_TILE_BITS)
+
+// u to the right, v up, as in the .obj files; 0 to 1 covers the texture once and it repeats outside
+typedef struct {
+    float u;
+    float v;
+} tex2_t;
+
+typedef enum {
+    // row after row, neighbours across rows are a whole row apart
+    TEXTURE_LINEAR,
+    // tiles row after row, the texels of a tile in morton (z) order, so nearby texels in any direction share cache lines and pages
+    // levels smaller than a tile still take a whole one
+    TEXTURE_TILED
+} texture_layout_t;
+
+typedef struct {
+    int width;              // powers of two, at least 1
+    int height;
+    int width_mask;         // width - 1, coordinates wrap with it
+    int height_mask;
+    int row_shift;          // log2 of the texels from one row, or one row of tiles, to the next
+    uint32_t* texels;       // points into the texture's allocation
+} texture_level_t;
+
+// argb texels with the full mip chain down to 1 x 1, every level a box filtered half of the one before
+typedef struct {
+    texture_layout_t layout;
+    int num_levels;
+    texture_level_t levels[TEXTURE_MAX_LEVELS];
+    uint32_t* texels;       // every level, level 0 first
+} texture_t;
+
+// builds an empty or freed texture from width x height argb pixels stored row by row, top row first
+// sides that aren't powers of two are resampled up to the next one
+void texture_from_pixels(texture_t* texture, const uint32_t* pixels, int width, int height, texture_layout_t layout);
+// checkerboard of size x size texels with squares of square_size, into an empty or freed texture
+void texture_make_checker(texture_t* texture, int size, int square_size, texture_layout_t layout);
+// replaces the texture with a binary (P6) .ppm with 8 bit channels, false and the texture left untouched if it can't be read
+bool texture_load_ppm(texture_t* texture, const char* filename, texture_layout_t layout);
+// rewrites every level in the other layout
+void texture_set_layout(texture_t* texture, texture_layout_t layout);
+void texture_free(texture_t* texture);
+
+// bit i of a coordinate inside a tile moves to bit 2 * i, tiles up to 32 texels wide
+static const uint16_t texture_morton_spread[32] = {
+    0, 1, 4, 5, 16, 17, 20, 21, 64, 65, 68, 69, 80, 81, 84, 85,
+    256, 257, 260, 261, 272, 273, 276, 277, 320, 321, 324, 325, 336, 337, 340, 341
+};
+
+// where the texel at x, y (already wrapped) is in the level's texels, the sides are powers of two so it's all shifts
+static inline int texture_texel_index(const texture_level_t* level, texture_layout_t layout, int x, int y) {
+    if (layout == TEXTURE_LINEAR) {
+        return (y << level->row_shift) | x;
+    }
+    int tile = ((y >> TEXTURE_TILE_BITS) << level->row_shift) | ((x >> TEXTURE_TILE_BITS) << (2 * TEXTURE_TILE_BITS));
+    return tile | texture_morton_spread[x & (TEXTURE_TILE_SIZE - 1)] | (texture_morton_spread[y & (TEXTURE_TILE_SIZE - 1)] << 1);
+}
+
+// floor without the libm call, for coordinates well inside the int range
+static inline int texture_floor(float f) {
+    int i = (int) f;
+    return i - (f < i);
+}
+
+// nearest texel of a level, uv repeats; v counts up from the bottom row, hence the flipped row
+static inline uint32_t texture_sample(const texture_t* texture, int level, float u, float v) {
+    const texture_level_t* l = &texture->levels[level];
+    int x = texture_floor(u * l->width) & l->width_mask;
+    int y = ~texture_floor(v * l->height) & l->height_mask;
+    return l->texels[texture_texel_index(l, texture->layout, x, y)];
+}
+
+// level for a footprint whose longer screen pixel step covers sqrt(texels_squared) level 0 texels
+static inline int texture_level_for(const texture_t* texture, float texels_squared) {
+    if (!(texels_squared > 1)) {
+        return 0;
+    }
+    // log2 of the length is half that of its square, compared as a float so an infinite footprint can't overflow the cast
+    float level = 0.5f * log2f(texels_squared);
+    return level < texture->num_levels - 1 ? (int) level : texture->num_levels - 1;
+}
+
+#endif
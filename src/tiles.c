@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+#include "tiles.h"
+#include "allocator.h"
+#include "profiler.h"
+
+SDL_Thread** tile_workers = NULL;
+int num_tile_workers = 0;
+
+SDL_mutex* tile_mutex = NULL;
+SDL_cond* tile_work_ready = NULL;
+SDL_cond* tile_work_done = NULL;
+int tile_job_generation = 0;
+int tile_workers_busy = 0;
+bool tile_workers_quit = false;
+
+// the current job, read-only while workers are running
+const triangle_t* tile_job_triangles = NULL;
+tile_draw_function_t tile_job_draw = NULL;
+SDL_atomic_t next_tile;
+
+int tiles_x = 0;
+int tiles_y = 0;
+
+// per-tile triangle lists stored back to back: tile t owns
+// tile_indices[tile_offsets[t] .. tile_offsets[t + 1])
+int* tile_offsets = NULL;
+int* tile_cursors = NULL;
+int tile_capacity = 0;
+int* tile_indices = NULL;
+int tile_indices_capacity = 0;
+
+// finds the range of tiles a triangle may touch, returns false if it is off-screen
+bool triangle_tile_range(const triangle_t* triangle, int* tx0, int* ty0, int* tx1, int* ty1) {
+    float min_x = fminf(triangle->points[0].x, fminf(triangle->points[1].x, triangle->points[2].x)) - TILE_BIN_MARGIN;
+    float min_y = fminf(triangle->points[0].y, fminf(triangle->points[1].y, triangle->points[2].y)) - TILE_BIN_MARGIN;
+    float max_x = fmaxf(triangle->points[0].x, fmaxf(triangle->points[1].x, triangle->points[2].x)) + TILE_BIN_MARGIN;
+    float max_y = fmaxf(triangle->points[0].y, fmaxf(triangle->points[1].y, triangle->points[2].y)) + TILE_BIN_MARGIN;
+
+    // written so that NaN coordinates are rejected as well
+    if (!(max_x >= 0 && max_y >= 0 && min_x < window_width && min_y < window_height)) {
+        return false;
+    }
+
+    *tx0 = min_x <= 0 ? 0 : (int) min_x / TILE_SIZE;
+    *ty0 = min_y <= 0 ? 0 : (int) min_y / TILE_SIZE;
+    *tx1 = max_x >= window_width ? tiles_x - 1 : (int) max_x / TILE_SIZE;
+    *ty1 = max_y >= window_height ? tiles_y - 1 : (int) max_y / TILE_SIZE;
+    return true;
+}
+
+void bin_triangles(const triangle_t* triangles, int num_triangles) {
+    tiles_x = (window_width + TILE_SIZE - 1) / TILE_SIZE;
+    tiles_y = (window_height + TILE_SIZE - 1) / TILE_SIZE;
+    int num_tiles = tiles_x * tiles_y;
+
+    if (num_tiles + 1 > tile_capacity) {
+        tile_capacity = num_tiles + 1;
+        tile_offsets = (int*) counted_realloc(tile_offsets, sizeof(int) * tile_capacity);
+        tile_cursors = (int*) counted_realloc(tile_cursors, sizeof(int) * tile_capacity);
+    }
+
+    for (int t=0; t<=num_tiles; t++) {
+        tile_offsets[t] = 0;
+    }
+
+    // first pass: count the triangles per tile
+    int tx0, ty0, tx1, ty1;
+    for (int i=0; i<num_triangles; i++) {
+        if (!triangle_tile_range(&triangles[i], &tx0, &ty0, &tx1, &ty1)) {
+            continue;
+        }
+        for (int ty=ty0; ty<=ty1; ty++) {
+            for (int tx=tx0; tx<=tx1; tx++) {
+                tile_offsets[ty * tiles_x + tx + 1]++;
+            }
+        }
+    }
+
+    // prefix sum turns the counts into start offsets
+    for (int t=0; t<num_tiles; t++) {
+        tile_offsets[t + 1] += tile_offsets[t];
+        tile_cursors[t] = tile_offsets[t];
+    }
+
+    int total = tile_offsets[num_tiles];
+    if (total > tile_indices_capacity) {
+        tile_indices_capacity = total * 2;
+        tile_indices = (int*) counted_realloc(tile_indices, sizeof(int) * tile_indices_capacity);
+    }
+
+    // second pass: fill the lists, triangles stay in submission order within a tile
+    for (int i=0; i<num_triangles; i++) {
+        if (!triangle_tile_range(&triangles[i], &tx0, &ty0, &tx1, &ty1)) {
+            continue;
+        }
+        for (int ty=ty0; ty<=ty1; ty++) {
+            for (int tx=tx0; tx<=tx1; tx++) {
+                tile_indices[tile_cursors[ty * tiles_x + tx]++] = i;
+            }
+        }
+    }
+}
+
+// grabs tiles until none are left, called by the workers and the main thread alike
+void rasterize_tiles(void) {
+    uint64_t tiles_start = profile_begin();
+    int num_tiles = tiles_x * tiles_y;
+
+    while (true) {
+        int t = SDL_AtomicAdd(&next_tile, 1);
+        if (t >= num_tiles) {
+            break;
+        }
+
+        int tx = t % tiles_x;
+        int ty = t / tiles_x;
+        clip_rect_t clip = {
+            .min_x = tx * TILE_SIZE,
+            .min_y = ty * TILE_SIZE,
+            .max_x = (tx + 1) * TILE_SIZE < window_width ? (tx + 1) * TILE_SIZE : window_width,
+            .max_y = (ty + 1) * TILE_SIZE < window_height ? (ty + 1) * TILE_SIZE : window_height
+        };
+
+        for (int k=tile_offsets[t]; k<tile_offsets[t + 1]; k++) {
+            tile_job_draw(&tile_job_triangles[tile_indices[k]], &clip);
+        }
+    }
+    profile_end("tiles", tiles_start);
+}
+
+int tile_worker(void* data) {
+    int seen_generation = 0;
+
+    while (true) {
+        SDL_LockMutex(tile_mutex);
+        while (tile_job_generation == seen_generation && !tile_workers_quit) {
+            SDL_CondWait(tile_work_ready, tile_mutex);
+        }
+        if (tile_workers_quit) {
+            SDL_UnlockMutex(tile_mutex);
+            return 0;
+        }
+        seen_generation = tile_job_generation;
+        SDL_UnlockMutex(tile_mutex);
+
+        rasterize_tiles();
+
+        SDL_LockMutex(tile_mutex);
+        tile_workers_busy--;
+        if (tile_workers_busy == 0) {
+            SDL_CondSignal(tile_work_done);
+        }
+        SDL_UnlockMutex(tile_mutex);
+    }
+}
+
+void tiles_initialize(int num_threads) {
+    tile_mutex = SDL_CreateMutex();
+    tile_work_ready = SDL_CreateCond();
+    tile_work_done = SDL_CreateCond();
+    tile_workers_quit = false;
+
+    // the calling thread rasterizes too, so it needs one worker less
+    num_tile_workers = num_threads > 1 ? num_threads - 1 : 0;
+    tile_workers = (SDL_Thread**) malloc(sizeof(SDL_Thread*) * (num_tile_workers + 1));
+
+    for (int i=0; i<num_tile_workers; i++) {
+        tile_workers[i] = SDL_CreateThread(tile_worker, "tile_worker", NULL);
+    }
+}
+
+void tiles_shutdown(void) {
+    SDL_LockMutex(tile_mutex);
+    tile_workers_quit = true;
+    SDL_CondBroadcast(tile_work_ready);
+    SDL_UnlockMutex(tile_mutex);
+
+    for (int i=0; i<num_tile_workers; i++) {
+        SDL_WaitThread(tile_workers[i], NULL);
+    }
+
+    free(tile_workers);
+    counted_free(tile_offsets);
+    counted_free(tile_cursors);
+    counted_free(tile_indices);
+    tile_workers = NULL;
+    tile_offsets = NULL;
+    tile_cursors = NULL;
+    tile_indices = NULL;
+    num_tile_workers = 0;
+    tile_capacity = 0;
+    tile_indices_capacity = 0;
+
+    SDL_DestroyCond(tile_work_ready);
+    SDL_DestroyCond(tile_work_done);
+    SDL_DestroyMutex(tile_mutex);
+}
+
+int tiles_thread_count(void) {
+    return num_tile_workers + 1;
+}
+
+void tiles_render(const triangle_t* triangles, int num_triangles, tile_draw_function_t draw) {
+    uint64_t bin_start = profile_begin();
+    bin_triangles(triangles, num_triangles);
+    profile_end("bin", bin_start);
+
+    SDL_LockMutex(tile_mutex);
+    tile_job_triangles = triangles;
+    tile_job_draw = draw;
+    SDL_AtomicSet(&next_tile, 0);
+    tile_workers_busy = num_tile_workers;
+    tile_job_generation++;
+    SDL_CondBroadcast(tile_work_ready);
+    SDL_UnlockMutex(tile_mutex);
+
+    rasterize_tiles();
+
+    // wait for the workers to finish their last tiles
+    SDL_LockMutex(tile_mutex);
+    while (tile_workers_busy > 0) {
+        SDL_CondWait(tile_work_done, tile_mutex);
+    }
+    SDL_UnlockMutex(tile_mutex);
+}
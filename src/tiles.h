@@ -0,0 +1,26 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include "display.h"
+#include "triangle.h"
+
+#define TILE_SIZE 64
+
+// extra pixels around a triangle's bounding box when binning
+// covers the vertex markers and the rounding of the line and fill rasterizers
+#define TILE_BIN_MARGIN 4
+
+// draws one triangle, touching only the pixels inside clip
+typedef void (*tile_draw_function_t)(const triangle_t* triangle, const clip_rect_t* clip);
+
+// starts the worker pool, num_threads includes the calling thread
+void tiles_initialize(int num_threads);
+void tiles_shutdown(void);
+int tiles_thread_count(void);
+
+// bins the triangles into screen tiles and rasterizes the tiles in parallel
+// every tile is owned by one thread and draws its triangles in submission order,
+// so the result is identical to drawing them one by one on a single thread
+void tiles_render(const triangle_t* triangles, int num_triangles, tile_draw_function_t draw);
+
+#endif
@@ -0,0 +1,226 @@
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "transform.h"
+#include "allocator.h"
+
+#if defined(TRANSFORM_AVX_KERNEL)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define TRANSFORM_AVX_TARGET
+#else
+#define TRANSFORM_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+int pad_to_batch(int count) {
+    return (count + TRANSFORM_BATCH - 1) / TRANSFORM_BATCH * TRANSFORM_BATCH;
+}
+
+float* soa_alloc(int padded_count) {
+    count_allocation();
+    float* array = (float*) SDL_SIMDAlloc(sizeof(float) * padded_count);
+    memset(array, 0, sizeof(float) * padded_count);
+    return array;
+}
+
+void vertex_soa_build(vertex_soa_t* soa, vec3_t* vertices, int count) {
+    vertex_soa_free(soa);
+
+    soa->count = count;
+    soa->padded_count = pad_to_batch(count);
+    soa->x = soa_alloc(soa->padded_count);
+    soa->y = soa_alloc(soa->padded_count);
+    soa->z = soa_alloc(soa->padded_count);
+
+    for (int i=0; i<count; i++) {
+        soa->x[i] = vertices[i].x;
+        soa->y[i] = vertices[i].y;
+        soa->z[i] = vertices[i].z;
+    }
+}
+
+void vertex_soa_free(vertex_soa_t* soa) {
+    SDL_SIMDFree(soa->x);
+    SDL_SIMDFree(soa->y);
+    SDL_SIMDFree(soa->z);
+    memset(soa, 0, sizeof(vertex_soa_t));
+}
+
+void vertex_stream_reserve(vertex_stream_t* stream, int padded_count) {
+    if (padded_count <= stream->capacity) {
+        return;
+    }
+
+    vertex_stream_free(stream);
+
+    stream->x = soa_alloc(padded_count);
+    stream->y = soa_alloc(padded_count);
+    stream->z = soa_alloc(padded_count);
+    stream->clip_x = soa_alloc(padded_count);
+    stream->clip_y = soa_alloc(padded_count);
+    stream->clip_z = soa_alloc(padded_count);
+    stream->clip_w = soa_alloc(padded_count);
+    stream->screen_x = soa_alloc(padded_count);
+    stream->screen_y = soa_alloc(padded_count);
+    stream->capacity = padded_count;
+}
+
+void vertex_stream_free(vertex_stream_t* stream) {
+    SDL_SIMDFree(stream->x);
+    SDL_SIMDFree(stream->y);
+    SDL_SIMDFree(stream->z);
+    SDL_SIMDFree(stream->clip_x);
+    SDL_SIMDFree(stream->clip_y);
+    SDL_SIMDFree(stream->clip_z);
+    SDL_SIMDFree(stream->clip_w);
+    SDL_SIMDFree(stream->screen_x);
+    SDL_SIMDFree(stream->screen_y);
+    memset(stream, 0, sizeof(vertex_stream_t));
+}
+
+void transform_vertices_scalar(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height) {
+    const mat4_t* m = world;
+    const mat4_t* p = projection;
+
+    for (int i=0; i<in->count; i++) {
+        float x = in->x[i];
+        float y = in->y[i];
+        float z = in->z[i];
+
+        // same operation order as mat4_mul_vec4 with w = 1
+        float tx = m->m[0][0] * x + m->m[0][1] * y + m->m[0][2] * z + m->m[0][3];
+        float ty = m->m[1][0] * x + m->m[1][1] * y + m->m[1][2] * z + m->m[1][3];
+        float tz = m->m[2][0] * x + m->m[2][1] * y + m->m[2][2] * z + m->m[2][3];
+
+        float cx = p->m[0][0] * tx + p->m[0][1] * ty + p->m[0][2] * tz + p->m[0][3];
+        float cy = p->m[1][0] * tx + p->m[1][1] * ty + p->m[1][2] * tz + p->m[1][3];
+        float cz = p->m[2][0] * tx + p->m[2][1] * ty + p->m[2][2] * tz + p->m[2][3];
+        float cw = p->m[3][0] * tx + p->m[3][1] * ty + p->m[3][2] * tz + p->m[3][3];
+
+        out->x[i] = tx;
+        out->y[i] = ty;
+        out->z[i] = tz;
+        out->clip_x[i] = cx;
+        out->clip_y[i] = cy;
+        out->clip_z[i] = cz;
+        out->clip_w[i] = cw;
+        out->screen_x[i] = (cx / cw) * half_width + half_width;
+        out->screen_y[i] = (cy / cw) * half_height + half_height;
+    }
+}
+
+#if defined(__SSE__)
+#define MUL_ADD4_SSE(r, x, y, z) _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r##0, x), _mm_mul_ps(r##1, y)), _mm_mul_ps(r##2, z)), r##3)
+
+void transform_vertices_sse(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height) {
+    __m128 m00 = _mm_set1_ps(world->m[0][0]), m01 = _mm_set1_ps(world->m[0][1]), m02 = _mm_set1_ps(world->m[0][2]), m03 = _mm_set1_ps(world->m[0][3]);
+    __m128 m10 = _mm_set1_ps(world->m[1][0]), m11 = _mm_set1_ps(world->m[1][1]), m12 = _mm_set1_ps(world->m[1][2]), m13 = _mm_set1_ps(world->m[1][3]);
+    __m128 m20 = _mm_set1_ps(world->m[2][0]), m21 = _mm_set1_ps(world->m[2][1]), m22 = _mm_set1_ps(world->m[2][2]), m23 = _mm_set1_ps(world->m[2][3]);
+    __m128 p00 = _mm_set1_ps(projection->m[0][0]), p01 = _mm_set1_ps(projection->m[0][1]), p02 = _mm_set1_ps(projection->m[0][2]), p03 = _mm_set1_ps(projection->m[0][3]);
+    __m128 p10 = _mm_set1_ps(projection->m[1][0]), p11 = _mm_set1_ps(projection->m[1][1]), p12 = _mm_set1_ps(projection->m[1][2]), p13 = _mm_set1_ps(projection->m[1][3]);
+    __m128 p20 = _mm_set1_ps(projection->m[2][0]), p21 = _mm_set1_ps(projection->m[2][1]), p22 = _mm_set1_ps(projection->m[2][2]), p23 = _mm_set1_ps(projection->m[2][3]);
+    __m128 p30 = _mm_set1_ps(projection->m[3][0]), p31 = _mm_set1_ps(projection->m[3][1]), p32 = _mm_set1_ps(projection->m[3][2]), p33 = _mm_set1_ps(projection->m[3][3]);
+    __m128 hw = _mm_set1_ps(half_width);
+    __m128 hh = _mm_set1_ps(half_height);
+
+    // the arrays are padded, so the tail is processed as a full batch
+    for (int i=0; i<in->count; i+=4) {
+        __m128 x = _mm_load_ps(in->x + i);
+        __m128 y = _mm_load_ps(in->y + i);
+        __m128 z = _mm_load_ps(in->z + i);
+
+        __m128 tx = MUL_ADD4_SSE(m0, x, y, z);
+        __m128 ty = MUL_ADD4_SSE(m1, x, y, z);
+        __m128 tz = MUL_ADD4_SSE(m2, x, y, z);
+
+        __m128 cx = MUL_ADD4_SSE(p0, tx, ty, tz);
+        __m128 cy = MUL_ADD4_SSE(p1, tx, ty, tz);
+        __m128 cz = MUL_ADD4_SSE(p2, tx, ty, tz);
+        __m128 cw = MUL_ADD4_SSE(p3, tx, ty, tz);
+
+        _mm_store_ps(out->x + i, tx);
+        _mm_store_ps(out->y + i, ty);
+        _mm_store_ps(out->z + i, tz);
+        _mm_store_ps(out->clip_x + i, cx);
+        _mm_store_ps(out->clip_y + i, cy);
+        _mm_store_ps(out->clip_z + i, cz);
+        _mm_store_ps(out->clip_w + i, cw);
+        _mm_store_ps(out->screen_x + i, _mm_add_ps(_mm_mul_ps(_mm_div_ps(cx, cw), hw), hw));
+        _mm_store_ps(out->screen_y + i, _mm_add_ps(_mm_mul_ps(_mm_div_ps(cy, cw), hh), hh));
+    }
+}
+#endif
+
+#if defined(TRANSFORM_AVX_KERNEL)
+#define MUL_ADD4_AVX(r, x, y, z) _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r##0, x), _mm256_mul_ps(r##1, y)), _mm256_mul_ps(r##2, z)), r##3)
+
+TRANSFORM_AVX_TARGET void transform_vertices_avx(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height) {
+    __m256 m00 = _mm256_set1_ps(world->m[0][0]), m01 = _mm256_set1_ps(world->m[0][1]), m02 = _mm256_set1_ps(world->m[0][2]), m03 = _mm256_set1_ps(world->m[0][3]);
+    __m256 m10 = _mm256_set1_ps(world->m[1][0]), m11 = _mm256_set1_ps(world->m[1][1]), m12 = _mm256_set1_ps(world->m[1][2]), m13 = _mm256_set1_ps(world->m[1][3]);
+    __m256 m20 = _mm256_set1_ps(world->m[2][0]), m21 = _mm256_set1_ps(world->m[2][1]), m22 = _mm256_set1_ps(world->m[2][2]), m23 = _mm256_set1_ps(world->m[2][3]);
+    __m256 p00 = _mm256_set1_ps(projection->m[0][0]), p01 = _mm256_set1_ps(projection->m[0][1]), p02 = _mm256_set1_ps(projection->m[0][2]), p03 = _mm256_set1_ps(projection->m[0][3]);
+    __m256 p10 = _mm256_set1_ps(projection->m[1][0]), p11 = _mm256_set1_ps(projection->m[1][1]), p12 = _mm256_set1_ps(projection->m[1][2]), p13 = _mm256_set1_ps(projection->m[1][3]);
+    __m256 p20 = _mm256_set1_ps(projection->m[2][0]), p21 = _mm256_set1_ps(projection->m[2][1]), p22 = _mm256_set1_ps(projection->m[2][2]), p23 = _mm256_set1_ps(projection->m[2][3]);
+    __m256 p30 = _mm256_set1_ps(projection->m[3][0]), p31 = _mm256_set1_ps(projection->m[3][1]), p32 = _mm256_set1_ps(projection->m[3][2]), p33 = _mm256_set1_ps(projection->m[3][3]);
+    __m256 hw = _mm256_set1_ps(half_width);
+    __m256 hh = _mm256_set1_ps(half_height);
+
+    // the arrays are padded, so the tail is processed as a full batch
+    for (int i=0; i<in->count; i+=8) {
+        __m256 x = _mm256_load_ps(in->x + i);
+        __m256 y = _mm256_load_ps(in->y + i);
+        __m256 z = _mm256_load_ps(in->z + i);
+
+        // no fma on purpose, so the results match the scalar path bit for bit
+        __m256 tx = MUL_ADD4_AVX(m0, x, y, z);
+        __m256 ty = MUL_ADD4_AVX(m1, x, y, z);
+        __m256 tz = MUL_ADD4_AVX(m2, x, y, z);
+
+        __m256 cx = MUL_ADD4_AVX(p0, tx, ty, tz);
+        __m256 cy = MUL_ADD4_AVX(p1, tx, ty, tz);
+        __m256 cz = MUL_ADD4_AVX(p2, tx, ty, tz);
+        __m256 cw = MUL_ADD4_AVX(p3, tx, ty, tz);
+
+        _mm256_store_ps(out->x + i, tx);
+        _mm256_store_ps(out->y + i, ty);
+        _mm256_store_ps(out->z + i, tz);
+        _mm256_store_ps(out->clip_x + i, cx);
+        _mm256_store_ps(out->clip_y + i, cy);
+        _mm256_store_ps(out->clip_z + i, cz);
+        _mm256_store_ps(out->clip_w + i, cw);
+        _mm256_store_ps(out->screen_x + i, _mm256_add_ps(_mm256_mul_ps(_mm256_div_ps(cx, cw), hw), hw));
+        _mm256_store_ps(out->screen_y + i, _mm256_add_ps(_mm256_mul_ps(_mm256_div_ps(cy, cw), hh), hh));
+    }
+}
+#endif
+
+void transform_vertices(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height) {
+#if defined(TRANSFORM_AVX_KERNEL)
+    // SDL reads the cpu features once and keeps them
+    if (SDL_HasAVX()) {
+        transform_vertices_avx(world, projection, in, out, half_width, half_height);
+        return;
+    }
+#endif
+#if defined(__SSE__)
+    transform_vertices_sse(world, projection, in, out, half_width, half_height);
+#else
+    transform_vertices_scalar(world, projection, in, out, half_width, half_height);
+#endif
+}
+
+const char* transform_kernel_name(void) {
+#if defined(TRANSFORM_AVX_KERNEL)
+    if (SDL_HasAVX()) {
+        return "avx";
+    }
+#endif
+#if defined(__SSE__)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
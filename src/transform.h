@@ -0,0 +1,60 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "vector.h"
+#include "matrix.h"
+
+// widest kernel lane count, every soa array is padded to a multiple of it
+#define TRANSFORM_BATCH 8
+
+// x86 gcc and clang build the avx kernel with a target attribute whatever the flags, so it's there to pick at runtime
+#if defined(__AVX__) || ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)))
+#define TRANSFORM_AVX_KERNEL
+#endif
+
+// structure-of-arrays copy of mesh positions
+// arrays are SIMD aligned and padded with zeros up to padded_count
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+    int count;
+    int padded_count;
+} vertex_soa_t;
+
+// post-transform vertex stream, one entry per mesh vertex
+typedef struct {
+    float* x;           // view space position
+    float* y;
+    float* z;
+    float* clip_x;      // homogeneous clip space position
+    float* clip_y;
+    float* clip_z;
+    float* clip_w;
+    float* screen_x;    // perspective divided and mapped to the viewport, only meaningful for vertices inside the near plane
+    float* screen_y;
+    int capacity;
+} vertex_stream_t;
+
+void vertex_soa_build(vertex_soa_t* soa, vec3_t* vertices, int count);
+void vertex_soa_free(vertex_soa_t* soa);
+
+void vertex_stream_reserve(vertex_stream_t* stream, int padded_count);
+void vertex_stream_free(vertex_stream_t* stream);
+
+// all kernels transform by world, then by projection, divide by w and map to the viewport
+// they produce bit-identical results, they only differ in how many vertices they handle per step
+void transform_vertices_scalar(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height);
+#if defined(__SSE__)
+void transform_vertices_sse(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height);
+#endif
+#if defined(TRANSFORM_AVX_KERNEL)
+// only call it where SDL_HasAVX()
+void transform_vertices_avx(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height);
+#endif
+
+// widest kernel both this build and the cpu running it have: avx where SDL_HasAVX(), else sse or scalar
+void transform_vertices(const mat4_t* world, const mat4_t* projection, const vertex_soa_t* in, vertex_stream_t* out, float half_width, float half_height);
+const char* transform_kernel_name(void);
+
+#endif
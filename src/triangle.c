@@ -7,6 +7,42 @@ void int_swap(int* a, int* b) {
     *b = t;
 }
 
+// fills the scanline y between x_start and x_end (inclusive, either order)
+// this writes the same pixels a horizontal draw_line would, but straight into the buffer
+// with a depth plane, pixels are depth tested first and hidden ones are skipped
+void fill_span(int x_start, int x_end, int y, uint32_t color, const depth_plane_t* depth, const clip_rect_t* clip) {
+    if (y < clip->min_y || y >= clip->max_y) {
+        return;
+    }
+
+    if (x_start > x_end) {
+        int_swap(&x_start, &x_end);
+    }
+
+    if (x_start < clip->min_x) x_start = clip->min_x;
+    if (x_end >= clip->max_x) x_end = clip->max_x - 1;
+
+    uint32_t* row = color_buffer + color_buffer_pitch * y;
+
+    if (depth == NULL) {
+        for (int x = x_start; x <= x_end; x++) {
+            row[x] = color;
+        }
+        return;
+    }
+
+    // larger 1/w is closer to the camera
+    float* depth_row = z_buffer + window_width * y;
+    float inv_w = depth->a * x_start + depth->b * y + depth->c;
+    for (int x = x_start; x <= x_end; x++) {
+        if (inv_w > depth_row[x]) {
+            depth_row[x] = inv_w;
+            row[x] = color;
+        }
+        inv_w += depth->a;
+    }
+}
+
 /*
       (x0,y0)
      /     \
@@ -15,7 +51,7 @@ void int_swap(int* a, int* b) {
 (x1,y1) ---- (x2,y2)
       
 */
-void fill_flat_bottom_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color) {
+void fill_flat_bottom_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const depth_plane_t* depth, const clip_rect_t* clip) {
     // find two inverted slopes for two triangle legs
     // because our y value increases by 1 consistently, 
     // so we are interested in the amount of change it causes in x values
@@ -28,9 +64,7 @@ void fill_flat_bottom_triangle(int x0, int y0, int x1, int y1, int x2, int y2, u
 
     // loop all the scanlines from top to bottom
     for (int y= y0; y <= y2; y++) {
-        // TODO: probably we do not need to use draw_line which recalculates stuff
-        // TODO: just should fill the array here without a function call
-        draw_line(x_start, y, x_end, y, color); 
+        fill_span(x_start, x_end, y, color, depth, clip);
 
         x_start += inv_slope1;
         x_end += inv_slope2;
@@ -43,7 +77,7 @@ void fill_flat_bottom_triangle(int x0, int y0, int x1, int y1, int x2, int y2, u
      \      /
       (x2,y2)
 */
-void fill_flat_top_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color) {
+void fill_flat_top_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const depth_plane_t* depth, const clip_rect_t* clip) {
     // find two inverted slopes for two triangle legs
     // because our y value increases by 1 consistently, 
     // so we are interested in the amount of change it causes in x values
@@ -56,9 +90,7 @@ void fill_flat_top_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint
 
     // loop all the scanlines from top to bottom
     for (int y= y2; y >= y0; y--) {
-        // TODO: probably we do not need to use draw_line which recalculates stuff
-        // TODO: just should fill the array here without a function call
-        draw_line(x_start, y, x_end, y, color); 
+        fill_span(x_start, x_end, y, color, depth, clip);
 
         x_start -= inv_slope1;
         x_end -= inv_slope2;
@@ -66,7 +98,7 @@ void fill_flat_top_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint
 }
 
 // this function draws using flat-top/flat-bottom method
-void draw_filled_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color) {
+void fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const depth_plane_t* depth, const clip_rect_t* clip) {
     // sort vertices by y-coordinate (ascending) -> y0 < y1 < y2
 
     if (y0 > y1) {
@@ -87,12 +119,12 @@ void draw_filled_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32
     if (y1 == y2) {
         // if the triangle is already in the flat bottom shape, we do not need to draw flat top
         fill_flat_bottom_triangle(
-            x0, y0, x1, y1, x2, y2, color
+            x0, y0, x1, y1, x2, y2, color, depth, clip
         );
     } else if (y0 == y1) {
         // if the triangle is already in the flat top shape, we do not need to draw the flat bottom
         fill_flat_top_triangle(
-            x0, y0, x1, y1, x2, y2, color
+            x0, y0, x1, y1, x2, y2, color, depth, clip
         );
     } else {
         // calculate the midpoint vertex
@@ -101,14 +133,63 @@ void draw_filled_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32
 
         // draw flat bottom triangle
         fill_flat_bottom_triangle(
-            x0, y0, x1, y1, mx, my, color
+            x0, y0, x1, y1, mx, my, color, depth, clip
         );
 
         // draw flat top triangle
         fill_flat_top_triangle(
-            x1, y1, mx, my, x2, y2, color
+            x1, y1, mx, my, x2, y2, color, depth, clip
         );
     }
 
 
-}
\ No newline at end of file
+}
+
+void draw_filled_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color) {
+    clip_rect_t clip = screen_rect();
+    draw_filled_triangle_clipped(x0, y0, x1, y1, x2, y2, color, &clip);
+}
+
+void draw_filled_triangle_clipped(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const clip_rect_t* clip) {
+    fill_triangle(x0, y0, x1, y1, x2, y2, color, NULL, clip);
+}
+
+// solves a*x + b*y + c = 1/w through the three projected vertices
+// returns false for triangles with no area, which cover no pixels to test
+bool triangle_depth_plane(const triangle_t* triangle, depth_plane_t* plane) {
+    return triangle_attribute_plane(triangle, triangle->inv_w, plane);
+}
+
+bool triangle_attribute_plane(const triangle_t* triangle, const float values[3], depth_plane_t* plane) {
+    float x0 = triangle->points[0].x, y0 = triangle->points[0].y;
+    float x1 = triangle->points[1].x, y1 = triangle->points[1].y;
+    float x2 = triangle->points[2].x, y2 = triangle->points[2].y;
+    float dw1 = values[1] - values[0];
+    float dw2 = values[2] - values[0];
+
+    float det = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (det == 0) {
+        return false;
+    }
+
+    plane->a = (dw1 * (y2 - y0) - dw2 * (y1 - y0)) / det;
+    plane->b = ((x1 - x0) * dw2 - (x2 - x0) * dw1) / det;
+    plane->c = values[0] - plane->a * x0 - plane->b * y0;
+    return true;
+}
+
+void draw_filled_triangle_depth_clipped(const triangle_t* triangle, const clip_rect_t* clip) {
+    depth_plane_t plane;
+    if (!triangle_depth_plane(triangle, &plane)) {
+        return;
+    }
+
+    fill_triangle(
+        triangle->points[0].x, triangle->points[0].y,
+        triangle->points[1].x, triangle->points[1].y,
+        triangle->points[2].x, triangle->points[2].y,
+        triangle->color,
+        &plane,
+        clip
+    );
+}
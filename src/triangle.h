@@ -3,20 +3,46 @@
 
 #include <stdint.h>
 #include "vector.h"
+#include "display.h"
+#include "dynarray.h"
+#include "texture.h"
 
 typedef struct {
     int a;
     int b;
     int c;
+    tex2_t a_uv;        // texture coordinates of each corner, 0, 0 when the mesh has none
+    tex2_t b_uv;
+    tex2_t c_uv;
     uint32_t color;
 } face_t;
 
 typedef struct {
     vec2_t points[3];
+    float inv_w[3];     // 1/w of each vertex, interpolated for the depth buffer
+    tex2_t texcoords[3];
     uint32_t color;
     float avg_depth;
 } triangle_t;
 
+typedef DYNARRAY(triangle_t) triangle_list_t;
+
+// 1/w over the screen as the plane a*x + b*y + c, which is exact under perspective,
+// and so is anything divided by w, like the texture coordinates
+typedef struct {
+    float a;
+    float b;
+    float c;
+} depth_plane_t;
+
 void draw_filled_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color);
+void draw_filled_triangle_clipped(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color, const clip_rect_t* clip);
+
+// the 1/w plane of the triangle, false for a triangle without area
+bool triangle_depth_plane(const triangle_t* triangle, depth_plane_t* plane);
+// the plane through values given at the three corners, false for a triangle without area
+bool triangle_attribute_plane(const triangle_t* triangle, const float values[3], depth_plane_t* plane);
+// fills the triangle with an early depth test against z_buffer, writing only the visible pixels
+void draw_filled_triangle_depth_clipped(const triangle_t* triangle, const clip_rect_t* clip);
 
 #endif
\ No newline at end of file
@@ -1,6 +1,18 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include <math.h>
+
+// every function is static inline so calls disappear into the caller and
+// by-value arguments never touch memory; float-only math throughout
+
+// 16-byte alignment lets vec4_t and mat4_t be loaded as whole SIMD registers
+#if defined(__GNUC__)
+#define MATH_ALIGN(n) __attribute__((aligned(n)))
+#else
+#define MATH_ALIGN(n)
+#endif
+
 typedef struct {
     float x, y;
 } vec2_t;
@@ -9,40 +21,203 @@ typedef struct {
     float x, y, z;
 } vec3_t;
 
-typedef struct {
+typedef struct MATH_ALIGN(16) {
     float x, y, z, w;
 } vec4_t;
 
 // vec2d functions
-float vec2_length(vec2_t v);
-vec2_t vec2_add(vec2_t a, vec2_t b);
-vec2_t vec2_sub(vec2_t a, vec2_t b);
-vec2_t vec2_mul(vec2_t v, float factor);
-vec2_t vec2_div(vec2_t v, float factor);
-float vec2_dot(vec2_t a, vec2_t b);
-void vec2_normalize(vec2_t* v);
+static inline float vec2_length(vec2_t v) {
+    return sqrtf(v.x * v.x + v.y * v.y);
+}
+
+static inline vec2_t vec2_add(vec2_t a, vec2_t b) {
+    vec2_t v = {
+        .x = a.x + b.x,
+        .y = a.y + b.y
+    };
+
+    return v;
+}
+
+static inline vec2_t vec2_sub(vec2_t a, vec2_t b) {
+    vec2_t v = {
+        .x = a.x - b.x,
+        .y = a.y - b.y
+    };
+
+    return v;
+}
+
+static inline vec2_t vec2_mul(vec2_t v, float factor) {
+    vec2_t r = {
+        .x = v.x * factor,
+        .y = v.y * factor
+    };
+
+    return r;
+}
+
+static inline vec2_t vec2_div(vec2_t v, float factor) {
+    vec2_t r = {
+        .x = v.x / factor,
+        .y = v.y / factor
+    };
+
+    return r;
+}
+
+static inline float vec2_dot(vec2_t a, vec2_t b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+static inline void vec2_normalize(vec2_t* v) {
+    float length = sqrtf(v->x * v->x + v->y * v->y);
+    v->x = v->x / length;
+    v->y = v->y / length;
+}
 
 // vec3d functions
-float vec3_length(vec3_t v);
-vec3_t vec3_add(vec3_t a, vec3_t b);
-vec3_t vec3_sub(vec3_t a, vec3_t b);
-vec3_t vec3_mul(vec3_t v, float factor);
-vec3_t vec3_div(vec3_t v, float factor);
+static inline float vec3_length(vec3_t v) {
+    return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+static inline vec3_t vec3_add(vec3_t a, vec3_t b) {
+    vec3_t v = {
+        .x = a.x + b.x,
+        .y = a.y + b.y,
+        .z = a.z + b.z
+    };
+
+    return v;
+}
+
+static inline vec3_t vec3_sub(vec3_t a, vec3_t b) {
+    vec3_t v = {
+        .x = a.x - b.x,
+        .y = a.y - b.y,
+        .z = a.z - b.z
+    };
+
+    return v;
+}
+
+static inline vec3_t vec3_mul(vec3_t v, float factor) {
+    vec3_t r = {
+        .x = v.x * factor,
+        .y = v.y * factor,
+        .z = v.z * factor
+    };
+
+    return r;
+}
+
+static inline vec3_t vec3_div(vec3_t v, float factor) {
+    vec3_t r = {
+        .x = v.x / factor,
+        .y = v.y / factor,
+        .z = v.z / factor
+    };
+
+    return r;
+}
+
 // cross product will give us the normal that's perpendicular to both vectors
-vec3_t vec3_cross(vec3_t a, vec3_t b);
+static inline vec3_t vec3_cross(vec3_t a, vec3_t b) {
+    vec3_t r = {
+        .x = a.y*b.z - a.z*b.y,
+        .y = a.z*b.x - a.x*b.z,
+        .z = a.x*b.y - a.y*b.x
+    };
+
+    return r;
+}
+
 // returns how aligned two vectors are
 // if dot > 0 => <90
 // if dot = 0 => 90
 // if dot < 0 => 90<
-float vec3_dot(vec3_t a, vec3_t b);
-void vec3_normalize(vec3_t* v);
+static inline float vec3_dot(vec3_t a, vec3_t b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// one divide for the reciprocal length, then three multiplies
+static inline void vec3_normalize(vec3_t* v) {
+    float inv_length = 1.0f / sqrtf(v->x * v->x + v->y * v->y + v->z * v->z);
+    v->x *= inv_length;
+    v->y *= inv_length;
+    v->z *= inv_length;
+}
+
+// one sinf and one cosf per call
+static inline vec3_t vec3_rotate_x(vec3_t v, float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+    vec3_t rotated_vector = {
+        .x = v.x,
+        .y = v.y * c - v.z * s,
+        .z = v.y * s + v.z * c
+    };
+
+    return rotated_vector;
+}
 
-vec3_t vec3_rotate_x(vec3_t v, float angle);
-vec3_t vec3_rotate_y(vec3_t v, float angle);
-vec3_t vec3_rotate_z(vec3_t v, float angle);
+static inline vec3_t vec3_rotate_y(vec3_t v, float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+    vec3_t rotated_vector = {
+        .x = v.x * c - v.z * s,
+        .y = v.y,
+        .z = v.x * s + v.z * c
+    };
+
+    return rotated_vector;
+}
+
+static inline vec3_t vec3_rotate_z(vec3_t v, float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+    vec3_t rotated_vector = {
+        .x = v.x * c - v.y * s,
+        .y = v.x * s + v.y * c,
+        .z = v.z
+    };
+
+    return rotated_vector;
+}
+
+// pointer variants for loops over arrays, out must not alias the inputs
+static inline void vec3_cross_into(vec3_t* restrict out, const vec3_t* restrict a, const vec3_t* restrict b) {
+    out->x = a->y * b->z - a->z * b->y;
+    out->y = a->z * b->x - a->x * b->z;
+    out->z = a->x * b->y - a->y * b->x;
+}
 
 // vec4D functions
-vec4_t vec4_from_vec3(vec3_t v);
-vec3_t vec3_from_vec4(vec4_t v);
+static inline vec4_t vec4_from_vec3(vec3_t v) {
+    vec4_t r = {
+        v.x, v.y, v.z, 1.0f
+    };
+
+    return r;
+}
+
+static inline vec3_t vec3_from_vec4(vec4_t v) {
+    vec3_t r = {
+        v.x, v.y, v.z
+    };
+
+    return r;
+}
+
+static inline vec4_t vec4_lerp(vec4_t a, vec4_t b, float t) {
+    vec4_t r = {
+        a.x + (b.x - a.x) * t,
+        a.y + (b.y - a.y) * t,
+        a.z + (b.z - a.z) * t,
+        a.w + (b.w - a.w) * t
+    };
+
+    return r;
+}
 
-#endif
\ No newline at end of file
+#endif